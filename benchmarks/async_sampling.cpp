@@ -0,0 +1,86 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      async_sampling.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark async sampling of a slow sample function.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  The sample function sleeps for a while before returning -- standing in for an ODE solve or a call to an external simulation.  This program times the
+  same refinement with the plain function, and with an async version (std::async) for several async window sizes.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <future>                                                        /* Futures                 C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <thread>                                                        /* threads                 C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+typedef mjr::tree15b2d1rT tt_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+double slow_func(tt_t::drpt_t x) {
+  std::this_thread::sleep_for(std::chrono::microseconds(500));
+  return x[0]*x[0]+x[1]*x[1]-0.5;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  auto pred = [](tt_t& tree) { return [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); }; };
+
+  {
+    std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+    tt_t tree;
+    tree.refine_grid(3, slow_func);
+    tree.refine_leaves_recursive_cell_pred(7, slow_func, pred(tree));
+    std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+    std::cout << "scalar" << std::endl;
+    std::cout << "  samples ......... " << tree.get_sample_count()                                          << std::endl;
+    std::cout << "  time ............ " << static_cast<std::chrono::duration<double>>(end_time-start_time) << std::endl;
+  }
+
+  auto async_func = [](tt_t::drpt_t x) { return std::async(std::launch::async, slow_func, x); };
+  for(std::size_t window: {1, 8, 64, 256}) {
+    std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+    tt_t tree;
+    tree.set_async_window(window);
+    tree.refine_grid_async(3, async_func);
+    tree.refine_leaves_recursive_cell_pred_async(7, async_func, pred(tree));
+    std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+    std::cout << "async window: " << window << std::endl;
+    std::cout << "  samples ......... " << tree.get_sample_count()                                          << std::endl;
+    std::cout << "  time ............ " << static_cast<std::chrono::duration<double>>(end_time-start_time) << std::endl;
+  }
+}
+/** @endcond */
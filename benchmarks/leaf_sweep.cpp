@@ -0,0 +1,121 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      leaf_sweep.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Count heap allocations made by cell queries during a leaf sweep.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  Count heap allocations (via a replacement global operator new) made by the cell queries used in a full leaf sweep of a 2D & 3D tree:
+    - vector: ccc_get_vertexes() & ccc_get_children() -- the std::vector returning versions
+    - array:  ccc_get_vertexes_array() & ccc_get_children_array() -- the allocation free versions
+    - preds:  cell_is_sampled(), cell_vertex_is_nan(), cell_cross_range_level(), & cell_below_range_level()
+    - leaves: get_leaf_cells() -- Only the result list should allocate
+  Each line reports the time & number of allocations.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <cstdlib>                                                       /* std:: C stdlib.h        C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <new>                                                           /* new & delete            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::size_t num_allocs = 0;
+
+// noinline keeps GCC from pairing the malloc/free inside these with new/delete at call sites (-Wmismatched-new-delete)
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  num_allocs++;
+  if (void* p = std::malloc(size == 0 ? 1 : size))
+    return p;
+  throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class func_t>
+void report(std::string name, func_t func) {
+  std::size_t start_allocs = num_allocs;
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  double sum = func();
+  std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+  std::cout << "  " << name << " time " << static_cast<std::chrono::duration<double>>(end_time-start_time) << " allocations " << (num_allocs - start_allocs) << " (checksum " << sum << ")" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_bench(std::string name, int level) {
+  tt_t tree;
+  tree.refine_grid(level, [](typename tt_t::drpt_t x) { return x[0]*x[0]+x[1]-0.5; });
+  typename tt_t::diti_list_t leaves = tree.get_leaf_cells();
+
+  std::cout << name << " (" << leaves.size() << " leaves)" << std::endl;
+  report("vector", [&tree, &leaves]() {
+    double sum = 0;
+    for(auto c: leaves) {
+      for(auto v: tree.ccc_get_vertexes(c))
+        sum += static_cast<double>(v);
+      for(auto v: tree.ccc_get_children(c))
+        sum += static_cast<double>(v);
+    }
+    return sum;
+  });
+  report("array ", [&tree, &leaves]() {
+    double sum = 0;
+    for(auto c: leaves) {
+      for(auto v: tree.ccc_get_vertexes_array(c))
+        sum += static_cast<double>(v);
+      for(auto v: tree.ccc_get_children_array(c))
+        sum += static_cast<double>(v);
+    }
+    return sum;
+  });
+  report("preds ", [&tree, &leaves]() {
+    double sum = 0;
+    for(auto c: leaves)
+      sum += (tree.cell_is_sampled(c) ? 1 : 0) + (tree.cell_vertex_is_nan(c) ? 1 : 0) + (tree.cell_cross_range_level(c, 0, 0.0) ? 1 : 0) + (tree.cell_below_range_level(c, 0, 0.0) ? 1 : 0);
+    return sum;
+  });
+  report("leaves", [&tree]() {
+    return static_cast<double>(tree.get_leaf_cells().size());
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  run_bench<mjr::MR_rect_tree<15, double, 2, 1>>("2D", 9);
+  run_bench<mjr::MR_rect_tree<15, double, 3, 1>>("3D", 6);
+}
+/** @endcond */
@@ -0,0 +1,81 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      parallel_grid.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark multithreaded refine_grid & leaf refinement.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  Times refine_grid() followed by refine_leaves_atomically_if_cell_pred() with an expensive sample function for several thread counts, and checks the
+  resulting trees are identical to the one thread result.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <cmath>                                                         /* std:: C math.h          C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+typedef mjr::tree15b2d1rT tt_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  auto func = [](tt_t::drpt_t x) {
+    double v = 0.0;
+    for(int i=1; i<200; i++)
+      v += std::sin(i*x[0])*std::cos(i*x[1])/i;
+    return v;
+  };
+
+  tt_t base_tree;
+  for(int thread_count: {1, 2, 4, 8, 0}) {
+    std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+    tt_t tree;
+    tree.set_thread_count(thread_count);
+    tree.refine_grid(9, func);
+    std::chrono::time_point<std::chrono::system_clock> grid_time = std::chrono::system_clock::now();
+    tree.refine_leaves_atomically_if_cell_pred(12, func, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+    std::chrono::time_point<std::chrono::system_clock> pred_time = std::chrono::system_clock::now();
+    if (thread_count == 1)
+      base_tree = tree;
+    bool same = (tree.get_sample_count() == base_tree.get_sample_count());
+    for(auto itr=base_tree.cbegin_samples(), jtr=tree.cbegin_samples(); same && (itr!=base_tree.cend_samples()); ++itr, ++jtr)
+      same = ((itr->first == jtr->first) && (itr->second == jtr->second));
+    std::cout << "threads: " << tree.get_thread_count() << std::endl;
+    std::cout << "  samples ......... " << tree.get_sample_count()                                          << std::endl;
+    std::cout << "  grid time ....... " << static_cast<std::chrono::duration<double>>(grid_time-start_time) << std::endl;
+    std::cout << "  pred time ....... " << static_cast<std::chrono::duration<double>>(pred_time-grid_time)  << std::endl;
+    std::cout << "  same as serial .. " << (same ? "YES" : "NO")                                          << std::endl;
+  }
+}
+/** @endcond */
@@ -0,0 +1,90 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      parallel_recursive.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark work stealing parallel recursive refinement.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  Times refine_leaves_recursive_cell_pred() on the implicit surfaces from implicit_surface.cpp & ear_surface.cpp (refined a couple levels deeper) with a
+  serial MR_flat_map tree, and refine_leaves_recursive_cell_pred_parallel() with an MR_sharded_map tree for several thread counts.  The per thread sample
+  counts show how well work stealing spreads the very unbalanced work.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+typedef mjr::tree15b3d1rT                                             ft_t;
+typedef mjr::MR_rect_tree<15, double, 3, 1, mjr::MR_sharded_map>      st_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+double implicit_isf(ft_t::drpt_t x) { return x[0]*x[0]*x[1]+x[1]*x[1]*x[0]-x[2]*x[2]*x[2]-1; }
+double ear_isf(ft_t::drpt_t x)      { return x[0]*x[0]-x[1]*x[1]*x[2]*x[2]+x[2]*x[2]*x[2]; }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tree_t>
+void run_bench(std::string name, double (*isf)(ft_t::drpt_t), int thread_count) {
+  tree_t tree({-2.3, -2.3, -2.3}, {2.3, 2.3, 2.3});
+  tree.refine_grid(3, isf);
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  std::vector<std::size_t> counts;
+  if constexpr (std::is_same_v<tree_t, ft_t>) {
+    tree.refine_leaves_recursive_cell_pred(9, isf, [&tree, isf](typename tree_t::diti_t i) { return (tree.cell_cross_sdf(i, isf)); });
+  } else {
+    tree.set_thread_count(thread_count);
+    counts = tree.refine_leaves_recursive_cell_pred_parallel(9, isf, [&tree, isf](typename tree_t::diti_t i) { return (tree.cell_cross_sdf(i, isf)); });
+  }
+  std::chrono::time_point<std::chrono::system_clock> end_time = std::chrono::system_clock::now();
+  std::cout << name << " threads: " << tree.get_thread_count() << std::endl;
+  std::cout << "  samples ......... " << tree.get_sample_count()                                          << std::endl;
+  std::cout << "  refine time ..... " << static_cast<std::chrono::duration<double>>(end_time-start_time) << std::endl;
+  if ( !(counts.empty())) {
+    std::cout << "  thread samples .. ";
+    for(auto c: counts)
+      std::cout << c << " ";
+    std::cout << std::endl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  for(auto [name, isf]: {std::pair<std::string, double (*)(ft_t::drpt_t)>{"implicit_surface", implicit_isf}, {"ear_surface", ear_isf}}) {
+    run_bench<ft_t>(name + " flat", isf, 1);
+    for(int thread_count: {1, 2, 4, 8, 32, 0})
+      run_bench<st_t>(name + " sharded", isf, thread_count);
+  }
+}
+/** @endcond */
@@ -0,0 +1,80 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      refine_callable.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark refinement with std::function & lambda arguments.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  The sampling & refinement members are templates accepting any invocable.  This program times the same refinement with the sample function & predicate
+  passed as lambdas (which may be inlined), wrapped in the std::function types (drpt2rrpt_func_t & diti2bool_func_t), and as a batch sample function
+  (drpt2rrpt_batch_func_t) working on blocks of points.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+typedef mjr::tree15b2d1rT tt_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class func_t, class pred_maker_t>
+void run_bench(std::string name, func_t func, pred_maker_t pred_maker) {
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  tt_t tree;
+  tree.refine_grid(9, func);
+  std::chrono::time_point<std::chrono::system_clock> grid_time = std::chrono::system_clock::now();
+  tree.refine_leaves_recursive_cell_pred(12, func, pred_maker(tree));
+  std::chrono::time_point<std::chrono::system_clock> pred_time = std::chrono::system_clock::now();
+
+  std::cout << name << std::endl;
+  std::cout << "  samples ......... " << tree.get_sample_count()                                            << std::endl;
+  std::cout << "  grid time ....... " << static_cast<std::chrono::duration<double>>(grid_time-start_time)  << std::endl;
+  std::cout << "  pred time ....... " << static_cast<std::chrono::duration<double>>(pred_time-grid_time)   << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  auto func = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+  auto pred = [](tt_t& tree) { return [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); }; };
+
+  run_bench("lambda",        func,                       pred);
+  run_bench("std::function", tt_t::drpt2rrpt_func_t(func), [&pred](tt_t& tree) { return tt_t::diti2bool_func_t(pred(tree)); });
+  run_bench("batch",         [](const tt_t::drpt_batch_t& x, const tt_t::rrpt_batch_t& y) {
+                               for(std::size_t k=0; k<x[0].size(); k++)
+                                 y[0][k] = x[0][k]*x[0][k]+x[1][k]*x[1][k]-0.5;
+                             },                          pred);
+}
+/** @endcond */
@@ -0,0 +1,189 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      sample_store.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark MR_rect_tree sample stores.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  Compare insert & probe cost for the MR_rect_tree sample stores:
+    - MR_flat_map (the default)
+    - MR_flat_map with std::hash instead of MR_diti_hash
+    - MR_std_unordered_map (std::unordered_map)
+    - MR_sorted_map (a frozen tree from freeze() -- query timings only)
+    - MR_flat_map with the uniform part of the tree packed into dense bricks (pack_bricks() -- query timings only)
+
+  Both a 2D and a 3D tree are uniformly sampled with refine_grid().  We then time:
+    - insert: refine_grid() with a trivial sample function (so the time is dominated by the store)
+    - hit:    vertex_exists() + get_sample() on every vertex of every leaf cell
+    - miss:   vertex_exists() on keys that are not in the tree (edge midpoints)
+  Sample store distribution statistics are printed after the timings.
+
+  Then MR_flat_map & MR_soa_map are compared on a 2D tree with a 15 component range (like tree15b2d15rT in performance_with_large_surface.cpp) for
+  single component work:
+    - cross:  cell_cross_range_level() on every leaf cell
+    - scan:   get_sample_component_min(), get_sample_component_max(), & count_nan_sample_components()
+  Each is run with double & float range storage (the rng_store_real_t template parameter).
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class key_t, class val_t, class hash_t>
+using flat_map_std_hash = mjr::MR_flat_map<key_t, val_t, std::hash<key_t>>;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void time_queries(const tt_t& tree, std::chrono::time_point<std::chrono::system_clock> insert_time) {
+
+  typename tt_t::diti_list_t leaves = tree.get_leaf_cells();
+  std::chrono::time_point<std::chrono::system_clock> leaf_time = std::chrono::system_clock::now();
+
+  double sum = 0;
+  std::size_t num_hit = 0;
+  for(auto c: leaves)
+    for(auto v: tree.ccc_get_vertexes(c))
+      if (tree.vertex_exists(v)) {
+        sum += tree.get_sample(v)[0];
+        num_hit++;
+      }
+  std::chrono::time_point<std::chrono::system_clock> hit_time = std::chrono::system_clock::now();
+
+  std::size_t num_miss = 0;
+  for(auto c: leaves)
+    for(int i=0; i<tt_t::domain_dimension; i++)
+      if ( !(tree.vertex_exists(tree.cuc_inc_crd(tree.ccc_cell_get_corner_min(c), i, tree.ccc_cell_half_width(c)))))
+        num_miss++;
+  std::chrono::time_point<std::chrono::system_clock> miss_time = std::chrono::system_clock::now();
+
+  std::cout << "  samples ......... " << tree.get_sample_count()                                                 << std::endl;
+  std::cout << "  leaves .......... " << leaves.size()                                                           << std::endl;
+  std::cout << "  leaf time ....... " << static_cast<std::chrono::duration<double>>(leaf_time-insert_time)      << std::endl;
+  std::cout << "  hit time ........ " << static_cast<std::chrono::duration<double>>(hit_time-leaf_time)         << " (" << num_hit  << " probes)" << std::endl;
+  std::cout << "  miss time ....... " << static_cast<std::chrono::duration<double>>(miss_time-hit_time)         << " (" << num_miss << " probes)" << std::endl;
+  std::cout << "  checksum ........ " << sum                                                                     << std::endl;
+  tree.dump_sample_store_stats();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_bench(std::string name, int level) {
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+
+  tt_t tree;
+  tree.refine_grid(level, [](typename tt_t::drpt_t x) { typename tt_t::rrpt_t r; r.fill(x[0]*x[0]); return r; });
+  std::chrono::time_point<std::chrono::system_clock> insert_time = std::chrono::system_clock::now();
+
+  std::cout << name << std::endl;
+  std::cout << "  insert time ..... " << static_cast<std::chrono::duration<double>>(insert_time-start_time)     << std::endl;
+  time_queries(tree, insert_time);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_freeze_bench(std::string name, int level) {
+  tt_t tree;
+  tree.refine_grid(level, [](typename tt_t::drpt_t x) { typename tt_t::rrpt_t r; r.fill(x[0]*x[0]); return r; });
+
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  typename tt_t::frozen_t ftree = tree.freeze();
+  std::chrono::time_point<std::chrono::system_clock> freeze_time = std::chrono::system_clock::now();
+
+  std::cout << name << std::endl;
+  std::cout << "  freeze time ..... " << static_cast<std::chrono::duration<double>>(freeze_time-start_time)     << std::endl;
+  time_queries(ftree, freeze_time);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_brick_bench(std::string name, int level, int brick_level) {
+  tt_t tree;
+  tree.refine_grid(level, [](typename tt_t::drpt_t x) { typename tt_t::rrpt_t r; r.fill(x[0]*x[0]); return r; });
+
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  int num_bricks = tree.pack_bricks(brick_level, level-brick_level);
+  std::chrono::time_point<std::chrono::system_clock> pack_time = std::chrono::system_clock::now();
+
+  std::cout << name << std::endl;
+  std::cout << "  pack time ....... " << static_cast<std::chrono::duration<double>>(pack_time-start_time)       << " (" << num_bricks << " bricks)" << std::endl;
+  time_queries(tree, pack_time);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_scan_bench(std::string name, int level) {
+  tt_t tree;
+  tree.refine_grid(level, [](typename tt_t::drpt_t x) { typename tt_t::rrpt_t r; for(int i=0; i<tt_t::range_dimension; i++) r[i] = x[0]*x[0]+x[1]*i; return r; });
+  typename tt_t::diti_list_t leaves = tree.get_leaf_cells();
+
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  std::size_t num_cross = 0;
+  for(auto c: leaves)
+    if (tree.cell_cross_range_level(c, 0, 0.25))
+      num_cross++;
+  std::chrono::time_point<std::chrono::system_clock> cross_time = std::chrono::system_clock::now();
+
+  double sum = 0;
+  for(int r=0; r<10; r++)
+    sum += tree.get_sample_component_min(3) + tree.get_sample_component_max(3) + static_cast<double>(tree.count_nan_sample_components(3));
+  std::chrono::time_point<std::chrono::system_clock> scan_time = std::chrono::system_clock::now();
+
+  std::cout << name << std::endl;
+  std::cout << "  samples ......... " << tree.get_sample_count()                                                 << std::endl;
+  std::cout << "  value bytes ..... " << tree.get_sample_count() * sizeof(typename tt_t::srpt_t)                 << std::endl;
+  std::cout << "  cross time ...... " << static_cast<std::chrono::duration<double>>(cross_time-start_time)      << " (" << num_cross << " crossing cells)" << std::endl;
+  std::cout << "  scan time ....... " << static_cast<std::chrono::duration<double>>(scan_time-cross_time)       << " (10 repetitions)" << std::endl;
+  std::cout << "  checksum ........ " << sum                                                                     << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  run_bench<mjr::MR_rect_tree<15, double, 2, 3>>(                           "2D MR_flat_map",             10);
+  run_bench<mjr::MR_rect_tree<15, double, 2, 3, flat_map_std_hash>>(        "2D MR_flat_map & std::hash", 10);
+  run_bench<mjr::MR_rect_tree<15, double, 2, 3, mjr::MR_std_unordered_map>>("2D MR_std_unordered_map",    10);
+  run_freeze_bench<mjr::MR_rect_tree<15, double, 2, 3>>(                    "2D frozen (MR_sorted_map)",  10);
+  run_brick_bench<mjr::MR_rect_tree<15, double, 2, 3>>(                     "2D bricks",                  10, 5);
+  run_bench<mjr::MR_rect_tree<15, double, 3, 3>>(                           "3D MR_flat_map",             6);
+  run_bench<mjr::MR_rect_tree<15, double, 3, 3, flat_map_std_hash>>(        "3D MR_flat_map & std::hash", 6);
+  run_bench<mjr::MR_rect_tree<15, double, 3, 3, mjr::MR_std_unordered_map>>("3D MR_std_unordered_map",    6);
+  run_freeze_bench<mjr::MR_rect_tree<15, double, 3, 3>>(                    "3D frozen (MR_sorted_map)",  6);
+  run_brick_bench<mjr::MR_rect_tree<15, double, 3, 3>>(                     "3D bricks",                  6,  3);
+  run_scan_bench<mjr::MR_rect_tree<15, double, 2, 15>>(                     "2D 15R MR_flat_map",         10);
+  run_scan_bench<mjr::MR_rect_tree<15, double, 2, 15, mjr::MR_soa_map>>(    "2D 15R MR_soa_map",          10);
+  run_scan_bench<mjr::MR_rect_tree<15, double, 2, 15, mjr::MR_flat_map, float>>("2D 15R MR_flat_map & float",  10);
+  run_scan_bench<mjr::MR_rect_tree<15, double, 2, 15, mjr::MR_soa_map, float>>( "2D 15R MR_soa_map & float",   10);
+}
+/** @endcond */
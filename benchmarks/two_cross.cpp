@@ -0,0 +1,143 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      two_cross.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Benchmark cross product point computation.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+ @filedetails   
+
+ @filedetails
+
+  Compare cuc_two_cross_array() (constexpr offset tables) with the per component loop it replaced, for dom_dim from 1 to 5.  For each dimension we
+  compute the corners, and the corners on each face, of a large number of cells.
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+/** @cond exj */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <chrono>                                                        /* time                    C++11    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The loop used by cuc_two_cross() before the offset tables
+template <class tt_t>
+typename tt_t::diti_corners_t loop_two_cross(const tt_t& tree, typename tt_t::diti_t diti, typename tt_t::dic_t delta) {
+  typename tt_t::diti_corners_t rv;
+  for(int i=0; i<(1 << tt_t::domain_dimension); i++) {
+    typename tt_t::diti_t tmp = diti;
+    for(int j=0; j<tt_t::domain_dimension; j++) {
+      if (i & (1 << j)) {
+        tmp = tree.cuc_inc_crd(tmp, j, delta);
+      } else {
+        tmp = tree.cuc_dec_crd(tmp, j, delta);
+      }
+    }
+    rv[i] = tmp;
+  }
+  return rv;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The loop used by the directional cuc_two_cross() before the offset tables
+template <class tt_t>
+typename tt_t::diti_face_corners_t loop_two_cross(const tt_t& tree, typename tt_t::diti_t diti, typename tt_t::dic_t delta, int index, int direction) {
+  typename tt_t::diti_face_corners_t rv;
+  if (direction != 1)
+    direction = 0;
+  int k = 0;
+  for(int i=0; i<(1 << tt_t::domain_dimension); i++) {
+    if (((i >> index) & 1) == direction) {
+      typename tt_t::diti_t tmp = diti;
+      for(int j=0; j<tt_t::domain_dimension; j++) {
+        if ((i >> j) & 1) {
+          tmp = tree.cuc_inc_crd(tmp, j, delta);
+        } else {
+          tmp = tree.cuc_dec_crd(tmp, j, delta);
+        }
+      }
+      rv[k++] = tmp;
+    }
+  }
+  return rv;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t, bool use_tables>
+double sweep(const tt_t& tree, const typename tt_t::diti_list_t& cells) {
+  typename tt_t::diti_t sum = 0;
+  for(int r=0; r<20; r++) {
+    for(auto c: cells) {
+      typename tt_t::dic_t hw = tree.ccc_cell_half_width(c);
+      if constexpr (use_tables) {
+        for(auto v: tree.cuc_two_cross_array(c, hw))
+          sum += v;
+        for(int i=0; i<tt_t::domain_dimension; i++)
+          for(auto v: tree.cuc_two_cross_array(c, hw, i, 1))
+            sum += v;
+      } else {
+        for(auto v: loop_two_cross(tree, c, hw))
+          sum += v;
+        for(int i=0; i<tt_t::domain_dimension; i++)
+          for(auto v: loop_two_cross(tree, c, hw, i, 1))
+            sum += v;
+      }
+    }
+  }
+  return static_cast<double>(sum);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void run_bench(std::string name, int level) {
+  tt_t tree;
+  tree.refine_recursive(level, [](typename tt_t::drpt_t) { return 1.0; });
+  typename tt_t::diti_list_t cells = tree.get_leaf_cells();
+
+  std::chrono::time_point<std::chrono::system_clock> start_time = std::chrono::system_clock::now();
+  double loop_sum = sweep<tt_t, false>(tree, cells);
+  std::chrono::time_point<std::chrono::system_clock> loop_time = std::chrono::system_clock::now();
+  double table_sum = sweep<tt_t, true>(tree, cells);
+  std::chrono::time_point<std::chrono::system_clock> table_time = std::chrono::system_clock::now();
+
+  std::cout << name << " (" << cells.size() << " cells)" << std::endl;
+  std::cout << "  loop time ....... " << static_cast<std::chrono::duration<double>>(loop_time-start_time)  << std::endl;
+  std::cout << "  table time ...... " << static_cast<std::chrono::duration<double>>(table_time-loop_time)  << std::endl;
+  std::cout << "  checksums ....... " << (loop_sum == table_sum ? "MATCH" : "DIFFERENT")                   << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main() {
+  run_bench<mjr::MR_rect_tree<15, double, 1, 1>>("1D", 14);
+  run_bench<mjr::MR_rect_tree<15, double, 2, 1>>("2D", 8);
+  run_bench<mjr::MR_rect_tree<15, double, 3, 1>>("3D", 5);
+  run_bench<mjr::MR_rect_tree<11, double, 4, 1>>("4D", 4);
+  run_bench<mjr::MR_rect_tree<11, double, 5, 1>>("5D", 3);
+}
+/** @endcond */
@@ -96,7 +96,7 @@ int main() {
   /* Convert our tree to a cell complex.  Note that we use an SDF to export only cells that contain our surface */
   tc_t::construct_geometry_fans(ccplx,
                                 tree,
-                                tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), [&tree](tt_t::diti_t i) { return (tree.cell_cross_sdf(i, isf)); }),
+                                tree.leaves_pred([&tree](tt_t::diti_t i) { return (tree.cell_cross_sdf(i, isf)); }),
                                 3,
                                 {{tc_t::val_src_spc_t::FDOMAIN, 0}, 
                                  {tc_t::val_src_spc_t::FDOMAIN, 1},
@@ -36,6 +36,7 @@
 #ifndef MJR_INCLUDE_MR_rt_to_cc
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <ranges>                                                        /* STL ranges              C++20    */
 #include <tuple>                                                         /* STL tuples              C++11    */
 #include <vector>                                                        /* STL vector              C++11    */
 #include <string>                                                        /* C++ strings             C++11    */
@@ -258,22 +259,24 @@ namespace mjr {
 
           @param ccplx             The MR_cell_cplx to populate with geometry
           @param rtree             The MR_rect_tree with source data
-          @param cells             List of cells to output from rtree
+          @param cells             Cells to output from rtree -- a list, or any range of cells (like rt_t::leaves() or rt_t::leaves_pred())
           @param output_dimension  Parts of cells to output
           @param point_src         Point sources
           @param func              The function was used to sample the tree */
+      template <class cell_range_t = rt_diti_list_t>
+      requires (std::ranges::input_range<const cell_range_t>)
       static int construct_geometry_fans(cc_t&               ccplx,
                                          const rt_t&         rtree,
-                                         rt_diti_list_t      cells,
+                                         const cell_range_t& cells,
                                          int                 output_dimension,
                                          val_src_lst_t       point_src,
                                          rt_drpt2rrpt_func_t func = nullptr
                                         ) {
         create_dataset_to_point_mapping(rtree, ccplx, point_src);
         if (rtree.domain_dimension == 1) {
-          for(auto& cell: cells) {
+          for(auto cell: cells) {
             cc_node_idx_t ctr_pnti = add_node(ccplx, rtree, cell);
-            rt_diti_list_t corners = rtree.ccc_get_corners(cell);
+            auto corners = rtree.ccc_get_corners_array(cell);
             cc_node_idx_t cn0_pnti = add_node(ccplx, rtree, corners[0]);
             cc_node_idx_t cn1_pnti = add_node(ccplx, rtree, corners[1]);
             if (func) { // We have a func, so we can "heal" broken edges.
@@ -306,7 +309,7 @@ namespace mjr {
             }
           }
         } else if (rtree.domain_dimension == 2) {
-          for(auto& cell: cells) {
+          for(auto cell: cells) {
             if (func) { // We have a func, so we can "heal" broken edges.
               for(int i=0; i<2; i++) {
                 for(int j=-1; j<2; j+=2) {
@@ -314,14 +317,14 @@ namespace mjr {
                   rt_diti_list_t nbrs = rtree.get_existing_neighbor(cell, i, j);
                   if (nbrs.size() > 1) {
                     for(auto n: nbrs) {
-                      rt_diti_list_t corners = rtree.ccc_get_corners(n, i, -j);
+                      auto corners = rtree.ccc_get_corners_array(n, i, -j);
                       if( ((i == 0) && (j == -1)) || ((i == 1) && (j == 1)) )
                         triangles.push_back({corners[1], corners[0], cell});
                       else
                         triangles.push_back({corners[0], corners[1], cell});
                     }
                   } else {
-                    rt_diti_list_t corners = rtree.ccc_get_corners(cell, i, j);
+                    auto corners = rtree.ccc_get_corners_array(cell, i, j);
                     if( ((i == 0) && (j == -1)) || ((i == 1) && (j == 1)) )
                       triangles.push_back({corners[1], corners[0], cell});
                     else
@@ -364,7 +367,7 @@ namespace mjr {
                     rt_diti_list_t nbrs = rtree.get_existing_neighbor(cell, i, j);
                     if (nbrs.size() > 1) {
                       for(auto n: nbrs) {
-                        rt_diti_list_t corners = rtree.ccc_get_corners(n, i, -j);
+                        auto corners = rtree.ccc_get_corners_array(n, i, -j);
                         cc_node_idx_t cn0_pnti = add_node(ccplx, rtree, corners[0]);
                         cc_node_idx_t cn1_pnti = add_node(ccplx, rtree, corners[1]);
                         if( ((i == 0) && (j == -1)) || ((i == 1) && (j == 1)) )
@@ -372,7 +375,7 @@ namespace mjr {
                         ccplx.add_cell(cc_t::cell_kind_t::TRIANGLE, {cn0_pnti, cn1_pnti, ctr_pnti}, output_dimension);
                       }
                     } else {
-                      rt_diti_list_t corners = rtree.ccc_get_corners(cell, i, j);
+                      auto corners = rtree.ccc_get_corners_array(cell, i, j);
                       cc_node_idx_t cn0_pnti = add_node(ccplx, rtree, corners[0]);
                       cc_node_idx_t cn1_pnti = add_node(ccplx, rtree, corners[1]);
                       if( ((i == 0) && (j == -1)) || ((i == 1) && (j == 1)) )
@@ -385,7 +388,7 @@ namespace mjr {
             }
           }
         } else if (rtree.domain_dimension == 3) {
-          for(auto& cell: cells) {
+          for(auto cell: cells) {
             cc_node_idx_list_t new_cell(5);
             new_cell[4] = add_node(ccplx, rtree, cell);
             std::array<int, 5> p {0, 1, 3, 2, 4};
@@ -395,13 +398,13 @@ namespace mjr {
                   rt_diti_list_t nbrs = rtree.get_existing_neighbor(cell, dim, dir);
                   if (nbrs.size() > 1) {
                     for(auto n: nbrs) {
-                      rt_diti_list_t corners = rtree.ccc_get_corners(n, dim, -dir);
+                      auto corners = rtree.ccc_get_corners_array(n, dim, -dir);
                       for(int k=0; k<4; ++k)
                         new_cell[p[k]] = add_node(ccplx, rtree, corners[k]);
                       ccplx.add_cell(cc_t::cell_kind_t::PYRAMID, new_cell, output_dimension);
                     }
                   } else {
-                    rt_diti_list_t corners = rtree.ccc_get_corners(cell, dim, dir);
+                    auto corners = rtree.ccc_get_corners_array(cell, dim, dir);
                     for(int k=0; k<4; ++k)
                       new_cell[p[k]] = add_node(ccplx, rtree, corners[k]);
                     ccplx.add_cell(cc_t::cell_kind_t::PYRAMID, new_cell, output_dimension);
@@ -424,7 +427,7 @@ namespace mjr {
                                          val_src_lst_t       point_src,
                                          rt_drpt2rrpt_func_t func = nullptr
                                         ) {
-        return construct_geometry_fans(ccplx, rtree, rtree.get_leaf_cells(), output_dimension, point_src, func);
+        return construct_geometry_fans(ccplx, rtree, rtree.leaves(), output_dimension, point_src, func);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Populate attached MR_cell_cplx object from data in attached MR_rect_tree object.
@@ -444,28 +447,30 @@ namespace mjr {
 
           @param ccplx           The MR_cell_cplx to populate with geometry
           @param rtree           The MR_rect_tree with source data
-          @param cells           List of tree cells from which to construct geometry
+          @param cells           Tree cells from which to construct geometry -- a list, or any range of cells (like rt_t::leaves())
           @param point_src       Point sources
           @param output_centers  Create vertexes for cell  centers
           @param output_corners  Create vertexes for cell corners*/
-      static int construct_geometry_points(cc_t&          ccplx,
-                                           const rt_t&    rtree,
-                                           rt_diti_list_t cells,
-                                           val_src_lst_t  point_src,
-                                           bool           output_centers,
-                                           bool           output_corners
+      template <class cell_range_t = rt_diti_list_t>
+      requires (std::ranges::input_range<const cell_range_t>)
+      static int construct_geometry_points(cc_t&               ccplx,
+                                           const rt_t&         rtree,
+                                           const cell_range_t& cells,
+                                           val_src_lst_t       point_src,
+                                           bool                output_centers,
+                                           bool                output_corners
                                           ) {
         create_dataset_to_point_mapping(rtree, ccplx, point_src);
         if (output_centers && output_corners) {
-          for(auto& cell: cells)
-            for(auto& vert: rtree.ccc_get_vertexes(cell))
+          for(auto cell: cells)
+            for(auto& vert: rtree.ccc_get_vertexes_array(cell))
               ccplx.add_cell(cc_t::cell_kind_t::POINT, {add_node(ccplx, rtree, vert)});
         } else if (output_centers) {
-          for(auto& cell: cells)
+          for(auto cell: cells)
             ccplx.add_cell(cc_t::cell_kind_t::POINT, {add_node(ccplx, rtree, cell)});
         } else if (output_corners) {
-          for(auto& cell: cells)
-            for(auto& vert: rtree.ccc_get_corners(cell))
+          for(auto cell: cells)
+            for(auto& vert: rtree.ccc_get_corners_array(cell))
               ccplx.add_cell(cc_t::cell_kind_t::POINT, {add_node(ccplx, rtree, vert)});
         } else {
           std::cout << "WARNING: construct_geometry_points: Both output_centers & output_corners are FALSE.  No geometry created!" << std::endl;
@@ -481,7 +486,7 @@ namespace mjr {
                                            bool          output_centers,
                                            bool          output_corners
                                           ) {
-        return construct_geometry_points(ccplx, rtree, rtree.get_leaf_cells(), point_src, output_centers, output_corners);
+        return construct_geometry_points(ccplx, rtree, rtree.leaves(), point_src, output_centers, output_corners);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Populate a MR_cell_cplx object from data in a MR_rect_tree object.
@@ -500,21 +505,23 @@ namespace mjr {
 
           @param ccplx                The MR_cell_cplx to populate with geometry
           @param rtree                The MR_rect_tree with source data
-          @param cells                List of tree cells from which to construct geometry
+          @param cells                Tree cells from which to construct geometry -- a list, or any range of cells (like rt_t::leaves())
           @param output_dimension     Parts of cells to output
           @param point_src            Point sources
           @param degenerate_fallback  If the rectangle is degenerate, try and make a triangle. (only works for cc_t::cell_kind_t::QUAD) */
-      static int construct_geometry_rects(cc_t&          ccplx,
-                                          const rt_t&    rtree,
-                                          rt_diti_list_t cells,
-                                          int            output_dimension,
-                                          val_src_lst_t  point_src,
-                                          bool           degenerate_fallback = true
+      template <class cell_range_t = rt_diti_list_t>
+      requires (std::ranges::input_range<const cell_range_t>)
+      static int construct_geometry_rects(cc_t&               ccplx,
+                                          const rt_t&         rtree,
+                                          const cell_range_t& cells,
+                                          int                 output_dimension,
+                                          val_src_lst_t       point_src,
+                                          bool                degenerate_fallback = true
                                          ) {
         create_dataset_to_point_mapping(rtree, ccplx, point_src);
-        for(auto& cell: cells) {
+        for(auto cell: cells) {
           std::vector<cc_node_idx_t> cnr_pti;
-          rt_diti_list_t corners = rtree.ccc_get_corners(cell);
+          auto corners = rtree.ccc_get_corners_array(cell);
           for(auto& corner: corners) {
             cc_node_idx_t pnti = add_node(ccplx, rtree, corner);
             cnr_pti.push_back(pnti);
@@ -549,7 +556,7 @@ namespace mjr {
                                           val_src_lst_t point_src,
                                           bool          degenerate_fallback = true
                                          ) {
-        return construct_geometry_rects(ccplx, rtree, rtree.get_leaf_cells(), output_dimension, point_src, degenerate_fallback);
+        return construct_geometry_rects(ccplx, rtree, rtree.leaves(), output_dimension, point_src, degenerate_fallback);
       }
       //@}
 
@@ -0,0 +1,386 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_flat_map.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_flat_map class.@EOL
+ @keywords  hash table open addressing robin hood
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_flat_map
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>                                                     /* STL algorithm           C++11    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iterator>                                                      /* STL Iterators           C++11    */
+#include <stdexcept>                                                     /* Exceptions              C++11    */
+#include <utility>                                                       /* STL Misc Utilities      C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Open addressing hash map used as the default sample store for MR_rect_tree.
+
+      This is a Robin Hood hash table with linear probing.  Key/value pairs are stored inline in a single flat array, and a parallel byte array holds the
+      probe distance of each slot (zero marks an empty slot).  Compared to std::unordered_map this avoids one heap allocation per element, and a lookup is
+      normally a short linear scan over adjacent memory instead of a pointer chase through a bucket list.
+
+      The slot for a key is computed from the hash via Fibonacci hashing (multiply by @f$2^{64}/\phi@f$ and keep the high bits).  This protects against
+      hash values with many trailing zero bits; however, it is not a substitute for a good hash function -- see MR_diti_hash for the one used by
+      MR_rect_tree.  Table quality can be checked with probe_length_counts().
+
+      The interface is the small subset of std::unordered_map used by MR_rect_tree: contains(), at(), operator[](), insert_or_assign(), erase(), size(),
+      reserve(), clear(), and const iteration over `std::pair<key_t, val_t>` elements.
+
+      @warning References and iterators are invalidated by any insertion, and by erase().
+      @warning val_t must be default constructible.
+
+      @tparam key_t  The key type
+      @tparam val_t  The mapped type
+      @tparam hash_t The hash function object type */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_flat_map {
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef key_t                     key_type;         //!< Key type
+      typedef val_t                     mapped_type;      //!< Mapped type
+      typedef std::pair<key_t, val_t>   value_type;       //!< Element type
+      typedef hash_t                    hasher;           //!< Hash function type
+      typedef std::size_t               size_type;        //!< Size type
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Private Constants */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static uint64_t fib_mult      = UINT64_C(11400714819323198485); // 2^64/phi
+      constexpr static int      min_cap_bits  = 3;                              // Smallest table is 8 slots
+      constexpr static uint8_t  max_probe     = 250;                            // Grow when a probe distance gets this long
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::vector<value_type> slots;             //!< Key/value storage
+      std::vector<uint8_t>    dists;             //!< Probe distance plus one for each slot.  Zero means empty.
+      size_type               num_elements = 0;  //!< Number of stored elements
+      int                     cap_bits     = 0;  //!< log2 of the number of slots.  Zero means no storage has been allocated.
+      hasher                  hash_func;         //!< Hash function object
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @brief Constant forward iterator for MR_flat_map.  Elements are visited in slot order. */
+      class const_iterator {
+        public:
+          typedef std::forward_iterator_tag iterator_category;
+          typedef MR_flat_map::value_type   value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef const value_type*         pointer;
+          typedef const value_type&         reference;
+          const_iterator() = default;
+          const_iterator(const MR_flat_map* new_map, size_type new_idx) : map(new_map), idx(new_idx) { skip_empty(); }
+          reference       operator*()  const { return map->slots[idx];  }
+          pointer         operator->() const { return &(map->slots[idx]); }
+          const_iterator& operator++()       { idx++; skip_empty(); return *this; }
+          const_iterator  operator++(int)    { const_iterator tmp = *this; ++(*this); return tmp; }
+          bool operator==(const const_iterator& other) const { return (idx == other.idx); }
+        private:
+          void skip_empty() { while ((idx < map->dists.size()) && (map->dists[idx] == 0)) idx++; }
+          const MR_flat_map* map = nullptr;
+          size_type          idx = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The iterator type.  Elements may not be modified via iterators, so this is the same as const_iterator. */
+      typedef const_iterator iterator;
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct an empty map.  No storage is allocated until the first insert. */
+      MR_flat_map() = default;
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Capacity */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements in the map */
+      inline size_type size() const { return num_elements; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if the map holds no elements */
+      inline bool empty() const { return (num_elements == 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of slots in the table */
+      inline size_type bucket_count() const { return slots.size(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Current load factor */
+      inline float load_factor() const { return (slots.empty() ? 0.0f : static_cast<float>(num_elements) / static_cast<float>(slots.size())); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Maximum load factor before the table grows.  Fixed at 7/8. */
+      inline float max_load_factor() const { return 0.875f; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Grow the table so that at least count elements may be held without a rehash.
+          @param count Number of elements */
+      void reserve(size_type count) {
+        int new_bits = std::max(cap_bits, min_cap_bits);
+        while (count * 8 > (static_cast<size_type>(1) << new_bits) * 7)
+          new_bits++;
+        if (new_bits != cap_bits)
+          rehash_bits(new_bits);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Histogram of probe lengths.
+          @return A vector with element i holding the number of elements stored i slots past their home slot.  Element zero counts elements in their home
+                  slot.  The vector is empty when the map is empty. */
+      std::vector<size_type> probe_length_counts() const {
+        std::vector<size_type> counts;
+        for(auto d: dists)
+          if (d) {
+            if (counts.size() < d)
+              counts.resize(d, 0);
+            counts[d-1]++;
+          }
+        return counts;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove all elements and release storage */
+      void clear() {
+        slots.clear();
+        slots.shrink_to_fit();
+        dists.clear();
+        dists.shrink_to_fit();
+        num_elements = 0;
+        cap_bits     = 0;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Lookup */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if key is in the map
+          @param key Key to search for */
+      inline bool contains(const key_t& key) const { return (find_slot(key) < slots.size()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Return 1 if key is in the map, and 0 otherwise.
+          @param key Key to search for */
+      inline size_type count(const key_t& key) const { return (contains(key) ? 1 : 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find an element
+          @param key Key to search for
+          @return Iterator to the element or end() if not found. */
+      inline const_iterator find(const key_t& key) const {
+        size_type idx = find_slot(key);
+        return (idx < slots.size() ? const_iterator(this, idx) : cend());
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element with bounds checking.
+          @param key Key to search for
+          @return Reference to the mapped value
+          @throws std::out_of_range if key is not in the map */
+      inline const val_t& at(const key_t& key) const {
+        size_type idx = find_slot(key);
+        if (idx >= slots.size())
+          throw std::out_of_range("MR_flat_map::at");
+        return slots[idx].second;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      inline val_t& at(const key_t& key) {
+        size_type idx = find_slot(key);
+        if (idx >= slots.size())
+          throw std::out_of_range("MR_flat_map::at");
+        return slots[idx].second;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Modifiers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element, inserting a default constructed value if the key is not in the map.
+          @param key Key to search for
+          @return Reference to the mapped value */
+      val_t& operator[](const key_t& key) {
+        bool inserted;
+        return slots[insert_key(key, inserted)].second;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Insert an element, or replace the value if the key is already in the map.
+          @param key   Key to insert
+          @param value Value to insert
+          @return A pair with an iterator to the element and true if a new element was inserted */
+      std::pair<const_iterator, bool> insert_or_assign(const key_t& key, const val_t& value) {
+        bool inserted;
+        size_type idx = insert_key(key, inserted);
+        slots[idx].second = value;
+        return {const_iterator(this, idx), inserted};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove an element.  Uses backward shift deletion, so no tombstones are left in the table.
+          @param key Key to remove
+          @return Number of elements removed (0 or 1) */
+      size_type erase(const key_t& key) {
+        size_type idx = find_slot(key);
+        if (idx >= slots.size())
+          return 0;
+        size_type mask = slots.size() - 1;
+        size_type nxt  = (idx + 1) & mask;
+        while (dists[nxt] > 1) {
+          slots[idx] = std::move(slots[nxt]);
+          dists[idx] = static_cast<uint8_t>(dists[nxt] - 1);
+          idx = nxt;
+          nxt = (nxt + 1) & mask;
+        }
+        dists[idx] = 0;
+        slots[idx] = value_type();
+        num_elements--;
+        return 1;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Iterators */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline const_iterator cbegin() const { return const_iterator(this, 0);            } //!< Iterator to first element
+      inline const_iterator cend()   const { return const_iterator(this, slots.size()); } //!< Iterator past the last element
+      inline const_iterator begin()  const { return cbegin();                           } //!< Iterator to first element
+      inline const_iterator end()    const { return cend();                             } //!< Iterator past the last element
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Table Mechanics */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Compute the home slot of a key.  Only valid when storage has been allocated. */
+      inline size_type home_slot(const key_t& key) const {
+        return static_cast<size_type>((static_cast<uint64_t>(hash_func(key)) * fib_mult) >> (64 - cap_bits));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find the slot holding key.
+          @return The slot index, or a value greater than or equal to slots.size() if key is not in the map. */
+      inline size_type find_slot(const key_t& key) const {
+        if (num_elements == 0)
+          return slots.size();
+        size_type mask = slots.size() - 1;
+        size_type idx  = home_slot(key);
+        uint8_t   dist = 1;
+        // Robin Hood invariant: once we hit a slot closer to its home than we are to ours, the key can't be further along.
+        while (dists[idx] >= dist) {
+          if ((dists[idx] == dist) && (slots[idx].first == key))
+            return idx;
+          idx = (idx + 1) & mask;
+          dist++;
+        }
+        return slots.size();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find the slot for key, inserting a default value if required.
+          @param key      Key to find or insert
+          @param inserted Set to true if key was inserted
+          @return The slot index for key */
+      size_type insert_key(const key_t& key, bool& inserted) {
+        size_type idx = find_slot(key);
+        if (idx < slots.size()) {
+          inserted = false;
+          return idx;
+        }
+        inserted = true;
+        if ((cap_bits == 0) || ((num_elements + 1) * 8 > slots.size() * 7))
+          rehash_bits(std::max(cap_bits + 1, min_cap_bits));
+        num_elements++;
+        return place(value_type(key, val_t()));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Place a new element in the table displacing richer elements as required.
+          If a probe sequence becomes too long, then the table is grown and the carried element is placed in the new table.  num_elements is not modified.
+          @param elt Element to place
+          @return The slot index where elt ended up */
+      size_type place(value_type elt) {
+        size_type  mask  = slots.size() - 1;
+        size_type  idx   = home_slot(elt.first);
+        uint8_t    dist  = 1;
+        key_t      key   = elt.first;
+        size_type  home  = slots.size();
+        value_type carry = std::move(elt);
+        while (true) {
+          if (dists[idx] == 0) {
+            slots[idx] = std::move(carry);
+            dists[idx] = dist;
+            return (home < slots.size() ? home : idx);
+          }
+          if (dists[idx] < dist) {
+            std::swap(carry, slots[idx]);
+            std::swap(dist,  dists[idx]);
+            if (home >= slots.size())
+              home = idx;
+          }
+          idx = (idx + 1) & mask;
+          dist++;
+          if (dist >= max_probe) {
+            rehash_bits(cap_bits + 1);
+            place(std::move(carry));
+            return find_slot(key);
+          }
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Resize the table to 2^new_bits slots and reinsert all elements. */
+      void rehash_bits(int new_bits) {
+        std::vector<value_type> old_slots(static_cast<size_type>(1) << new_bits);
+        std::vector<uint8_t>    old_dists(static_cast<size_type>(1) << new_bits, 0);
+        std::swap(old_slots, slots);
+        std::swap(old_dists, dists);
+        cap_bits = new_bits;
+        for(size_type i=0; i<old_slots.size(); i++)
+          if (old_dists[i])
+            place(std::move(old_slots[i]));
+      }
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_flat_map
+#endif
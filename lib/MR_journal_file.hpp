@@ -0,0 +1,353 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_journal_file.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_journal_file class.@EOL
+ @keywords  journal write ahead log checkpoint restart
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_journal_file
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>                                                     /* STL algorithm           C++11    */
+#include <concepts>                                                      /* Concepts library        C++20    */
+#include <condition_variable>                                            /* Condition variables     C++11    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <cstring>                                                       /* std:: C string.h        C++11    */
+#include <deque>                                                         /* STL deque               C++11    */
+#include <filesystem>                                                    /* C++ filesystem          C++17    */
+#include <fstream>                                                       /* C++ fstream             C++98    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <mutex>                                                         /* Mutexes                 C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+#include <thread>                                                        /* threads                 C++11    */
+#include <type_traits>                                                   /* C++ metaprogramming     C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Append only write ahead log used by MR_rect_tree to survive crashes during long refinement runs.
+
+      The file starts with a 24 byte header: the 8 byte magic string "MRJRNL01", the key size & value size as 32-bit integers, and a 64-bit context
+      identifying what the keys mean (MR_rect_tree uses a hash of the bounding box, max_level, & dimensions).  The rest of the file is a sequence of fixed
+      size records: a key followed by a value -- all in native byte order.  A key may appear many times, and the last record for a key wins.
+
+      append() copies records into a batch buffer.  Full batches are handed to a writer thread, so the caller only pays for a memcpy, and only waits if the
+      writer falls several batches behind.  flush() waits until every record appended so far has been written.  Records are written with ordinary file
+      writes, so they survive a crash of the process, but not necessarily a crash of the operating system.  At most one batch plus the records queued for
+      the writer are lost when the process dies.
+
+      A record torn by a crash is removed when the journal is resumed.
+
+      @tparam key_t  The key type.  Must be trivially copyable.
+      @tparam val_t  The value type.  Must be trivially copyable. */
+  template <class key_t, class val_t>
+  class MR_journal_file {
+
+      static_assert(std::is_trivially_copyable<key_t>::value, "MR_journal_file: key_t must be trivially copyable");
+      static_assert(std::is_trivially_copyable<val_t>::value, "MR_journal_file: val_t must be trivially copyable");
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef std::size_t size_type;        //!< Size type
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Private Constants */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static char      magic[9]        = "MRJRNL01";
+      constexpr static size_type header_size     = 24;
+      constexpr static size_type record_size     = sizeof(key_t) + sizeof(val_t);
+      constexpr static size_type read_chunk_size = 1 << 20;     // Bytes read at once when resuming
+      constexpr static size_type batch_size      = 1 << 16;     // Bytes in a batch handed to the writer thread
+      constexpr static size_type max_queued      = 4;           // Batches waiting for the writer before append() blocks
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::string                   file_name;              //!< Name of the open file.  Empty if no file is open.
+      uint64_t                      context = 0;            //!< Context of the journal
+      size_type                     record_count = 0;       //!< Number of records resumed & appended
+      std::vector<char>             batch;                  //!< Records being collected by append()
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::ofstream                 out_stream;             //!< Unbuffered append stream.  Only used by the writer thread.
+      std::thread                   writer;                 //!< The writer thread
+      std::mutex                    queue_mutex;            //!< Guards the following members
+      std::condition_variable       queue_cv;               //!< Signaled when the queue or the writer state changes
+      std::deque<std::vector<char>> queue;                  //!< Batches waiting for the writer
+      bool                          writing      = false;   //!< Writer is writing a batch
+      bool                          stopping     = false;   //!< Writer should exit when the queue is empty
+      bool                          write_failed = false;   //!< A write failed
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors & Destructor */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct with no open file. */
+      MR_journal_file() = default;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      MR_journal_file(const MR_journal_file&) = delete;
+      MR_journal_file& operator=(const MR_journal_file&) = delete;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Writes all records, and closes the file. */
+      ~MR_journal_file() { close(); }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name File Operations */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Create a new, empty, journal.  An existing file is truncated.  Any open file is closed first.
+          @param new_file_name Name of the file
+          @param new_context   Context of the journal
+          @return 0 on success, and 1 on error (the journal will be closed) */
+      int create(std::string new_file_name, uint64_t new_context) {
+        close();
+        std::ofstream hdr_stream(new_file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+        if ( !(hdr_stream.is_open())) {
+          std::cout << "ERROR(MR_journal_file::create): Could not create file!" << std::endl;
+          return 1;
+        }
+        hdr_stream.write(header(new_context).data(), header_size);
+        hdr_stream.close();
+        if (hdr_stream.fail()) {
+          std::cout << "ERROR(MR_journal_file::create): Could not write file header!" << std::endl;
+          return 1;
+        }
+        return start(new_file_name, new_context);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Read every record in an existing journal, and then reopen it for appending.  Any open file is closed first.
+          @param new_file_name Name of the file
+          @param new_context   Context of the journal.  Must match the context in the file.
+          @param func          Called with each key & value in the file (in file order)
+          @return 0 on success, and 1 on error (the journal will be closed) */
+      template <class func_t>
+      requires (std::invocable<func_t&, const key_t&, const val_t&>)
+      int resume(std::string new_file_name, uint64_t new_context, func_t&& func) {
+        close();
+        std::ifstream in_stream(new_file_name, std::ios::in | std::ios::binary);
+        std::vector<char> hdr(header_size);
+        if ( !(in_stream.is_open()) || !(in_stream.read(hdr.data(), header_size))) {
+          std::cout << "ERROR(MR_journal_file::resume): Could not read file header!" << std::endl;
+          return 1;
+        }
+        if ( !(std::equal(hdr.cbegin(), hdr.cbegin()+16, header(new_context).cbegin()))) {
+          std::cout << "ERROR(MR_journal_file::resume): Bad file header (wrong file type or wrong key/value size)!" << std::endl;
+          return 1;
+        }
+        if (hdr != header(new_context)) {
+          std::cout << "ERROR(MR_journal_file::resume): Journal is for a different context!" << std::endl;
+          return 1;
+        }
+        std::uintmax_t good_size = header_size;
+        std::vector<char> buf(read_chunk_size / record_size * record_size);
+        while (in_stream) {
+          in_stream.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+          size_type num_records = static_cast<size_type>(in_stream.gcount()) / record_size;
+          for(size_type i=0; i<num_records; i++) {
+            key_t key;
+            val_t value;
+            std::memcpy(&key,   buf.data() + i * record_size,                 sizeof(key_t));
+            std::memcpy(&value, buf.data() + i * record_size + sizeof(key_t), sizeof(val_t));
+            func(key, value);
+          }
+          record_count += num_records;
+          good_size    += num_records * record_size;
+        }
+        in_stream.close();
+        std::error_code ec;
+        if (std::filesystem::file_size(new_file_name, ec) > good_size)
+          std::filesystem::resize_file(new_file_name, good_size, ec);
+        if (ec) {
+          std::cout << "ERROR(MR_journal_file::resume): Could not remove torn record!" << std::endl;
+          return 1;
+        }
+        size_type num_resumed = record_count;
+        int ret = start(new_file_name, new_context);
+        record_count = num_resumed;
+        return ret;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Wait until every record appended so far has been written.
+          @return 0 on success, and 1 if any write has failed */
+      int flush() {
+        if ( !(is_open()))
+          return 0;
+        submit();
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [this]() { return (queue.empty() && !(writing)); });
+        return (write_failed ? 1 : 0);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Write all records, stop the writer thread, and close the file. */
+      void close() {
+        if ( !(is_open()))
+          return;
+        flush();
+        {
+          std::lock_guard<std::mutex> lock(queue_mutex);
+          stopping = true;
+        }
+        queue_cv.notify_all();
+        writer.join();
+        out_stream.close();
+        file_name.clear();
+        record_count = 0;
+        stopping     = false;
+        write_failed = false;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Access */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if a file is open */
+      inline bool is_open() const { return !(file_name.empty()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Name of the open file.  Empty if no file is open. */
+      inline const std::string& get_file_name() const { return file_name; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Context of the journal */
+      inline uint64_t get_context() const { return context; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of records read by resume() plus the number appended since */
+      inline size_type get_record_count() const { return record_count; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Add a record.  Not thread safe -- only one thread may append to a journal.
+          @param key   Key to add
+          @param value Value to add */
+      void append(const key_t& key, const val_t& value) {
+        if ( !(is_open()))
+          return;
+        size_type pos = batch.size();
+        batch.resize(pos + record_size);
+        std::memcpy(batch.data() + pos,                 &key,   sizeof(key_t));
+        std::memcpy(batch.data() + pos + sizeof(key_t), &value, sizeof(val_t));
+        record_count++;
+        if (batch.size() >= batch_size)
+          submit();
+      }
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Writer */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Open the file for appending, and start the writer thread. */
+      int start(std::string new_file_name, uint64_t new_context) {
+        out_stream.rdbuf()->pubsetbuf(nullptr, 0);
+        out_stream.open(new_file_name, std::ios::out | std::ios::binary | std::ios::app);
+        if ( !(out_stream.is_open())) {
+          std::cout << "ERROR(MR_journal_file::start): Could not open file for append!" << std::endl;
+          return 1;
+        }
+        file_name    = new_file_name;
+        context      = new_context;
+        record_count = 0;
+        batch.reserve(batch_size + record_size);
+        writer = std::thread([this]() { write_batches(); });
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Hand the current batch to the writer thread.  Waits if the writer is too far behind. */
+      void submit() {
+        if (batch.empty())
+          return;
+        {
+          std::unique_lock<std::mutex> lock(queue_mutex);
+          queue_cv.wait(lock, [this]() { return (queue.size() < max_queued); });
+          queue.push_back(std::move(batch));
+        }
+        queue_cv.notify_all();
+        batch = std::vector<char>();
+        batch.reserve(batch_size + record_size);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Writer thread body.  Write batches in order until stopped. */
+      void write_batches() {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        while (true) {
+          queue_cv.wait(lock, [this]() { return (stopping || !(queue.empty())); });
+          if (queue.empty())
+            return;
+          std::vector<char> buf = std::move(queue.front());
+          queue.pop_front();
+          writing = true;
+          lock.unlock();
+          out_stream.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+          out_stream.flush();
+          lock.lock();
+          if (out_stream.fail())
+            write_failed = true;
+          writing = false;
+          queue_cv.notify_all();
+        }
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name File Header */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The expected file header */
+      static std::vector<char> header(uint64_t hdr_context) {
+        std::vector<char> hdr(header_size);
+        uint32_t key_size = sizeof(key_t);
+        uint32_t val_size = sizeof(val_t);
+        std::memcpy(hdr.data(),      magic,        8);
+        std::memcpy(hdr.data() + 8,  &key_size,    4);
+        std::memcpy(hdr.data() + 12, &val_size,    4);
+        std::memcpy(hdr.data() + 16, &hdr_context, 8);
+        return hdr;
+      }
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_journal_file
+#endif
@@ -0,0 +1,329 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_mapped_map.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_mapped_map class.@EOL
+ @keywords  memory mapped file sorted array map binary search immutable
+ @std       C++23
+ @see       MR_rect_tree.hpp, MR_sorted_map.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_mapped_map
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>                                                     /* STL algorithm           C++11    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <fstream>                                                       /* C++ fstream             C++98    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <iterator>                                                      /* STL Iterators           C++11    */
+#include <memory>                                                        /* Smart pointers          C++11    */
+#include <stdexcept>                                                     /* Exceptions              C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+#include <type_traits>                                                   /* C++ metaprogramming     C++11    */
+#include <utility>                                                       /* STL Misc Utilities      C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+#if __has_include(<sys/mman.h>)
+#define MJR_MAPPED_MAP_MMAP 1
+#include <fcntl.h>                                                       /* POSIX open              POSIX    */
+#include <sys/mman.h>                                                    /* POSIX mmap              POSIX    */
+#include <sys/stat.h>                                                    /* POSIX fstat             POSIX    */
+#include <unistd.h>                                                      /* POSIX close             POSIX    */
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Immutable sorted array map whose keys & values live in a memory mapped file.  Used as the sample store for MR_rect_tree_view.
+
+      The file holds a sorted array of keys, and an array of values in the same order -- for example the sample arrays of a file written by
+      MR_rect_tree::save().  map_file() maps the file, and lookups read the arrays directly from the mapped pages.  Nothing is read or copied when the file
+      is opened, so even very large files open almost instantly, the operating system only reads the pages actually used, and processes mapping the same
+      file share one copy in the page cache.  Copies of a map share the mapping, and the mapping is removed when the last copy is destroyed.
+
+      Lookups are a branch free binary search over the mapped keys.  Unlike MR_sorted_map there is no high bit index, as building one would read every key
+      when the file is opened.  So lookups are a bit slower than MR_sorted_map -- load() a file into a frozen tree instead of mapping it when the tree will be
+      queried heavily.
+
+      On systems without POSIX mmap() the file is read into memory by map_file().
+
+      The file must not be modified while it is mapped.
+
+      The interface is the read only subset of std::unordered_map used by MR_rect_tree.  Iteration is in increasing key order, and iterators dereference to a
+      `std::pair<key_t, val_t>` by value.
+
+      @tparam key_t  The key type -- must be an unsigned integer type
+      @tparam val_t  The mapped type.  Must be trivially copyable.
+      @tparam hash_t Ignored.  Present so that this template may be used as an MR_rect_tree store_t */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_mapped_map {
+
+    static_assert(std::is_unsigned<key_t>::value,             "MR_mapped_map: key_t must be an unsigned integer type");
+    static_assert(std::is_trivially_copyable<val_t>::value,   "MR_mapped_map: val_t must be trivially copyable");
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef key_t                     key_type;         //!< Key type
+      typedef val_t                     mapped_type;      //!< Mapped type
+      typedef std::pair<key_t, val_t>   value_type;       //!< Element type (returned by value)
+      typedef std::size_t               size_type;        //!< Size type
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Mapped Regions */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @brief An entire file mapped into memory (or read into memory where mmap() is not available).  Not copyable. */
+      class region_t {
+        public:
+          region_t() = default;
+          region_t(const region_t&) = delete;
+          region_t& operator=(const region_t&) = delete;
+          ~region_t() {
+#ifdef MJR_MAPPED_MAP_MMAP
+            if (data != nullptr)
+              munmap(const_cast<char*>(data), length);
+#endif
+          }
+          /** Map a file.  @return 0 on success, and 1 on error */
+          int open(std::string file_name) {
+#ifdef MJR_MAPPED_MAP_MMAP
+            int fd = ::open(file_name.c_str(), O_RDONLY);
+            if (fd < 0)
+              return 1;
+            struct stat st;
+            if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+              ::close(fd);
+              return 1;
+            }
+            length = static_cast<std::size_t>(st.st_size);
+            void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (addr == MAP_FAILED)
+              return 1;
+            data = static_cast<const char*>(addr);
+#else
+            std::ifstream in_stream(file_name, std::ios::in | std::ios::binary | std::ios::ate);
+            if ( !(in_stream.is_open()))
+              return 1;
+            buffer.resize(static_cast<std::size_t>(in_stream.tellg()));
+            in_stream.seekg(0);
+            in_stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (in_stream.fail())
+              return 1;
+            data   = buffer.data();
+            length = buffer.size();
+#endif
+            return 0;
+          }
+          const char*       data   = nullptr;  //!< First byte of the file
+          std::size_t       length = 0;        //!< Length of the file in bytes
+#ifndef MJR_MAPPED_MAP_MMAP
+          std::vector<char> buffer;            //!< File contents
+#endif
+      };
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::shared_ptr<const region_t> region;           //!< The mapped file.  Shared by copies of the map.
+      const key_t*                    keys = nullptr;   //!< Sorted keys (in the mapped file)
+      const val_t*                    vals = nullptr;   //!< Values in the same order as keys (in the mapped file)
+      size_type                       num  = 0;         //!< Number of elements
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @brief Constant forward iterator for MR_mapped_map.  Elements are visited in key order, and are returned by value. */
+      class const_iterator {
+        public:
+          /** Holds an element so that operator->() has something to point at. */
+          struct arrow_proxy {
+            value_type elt;
+            const value_type* operator->() const { return &elt; }
+          };
+          typedef std::forward_iterator_tag iterator_category;
+          typedef MR_mapped_map::value_type value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef arrow_proxy               pointer;
+          typedef value_type                reference;
+          const_iterator() = default;
+          const_iterator(const MR_mapped_map* new_map, size_type new_idx) : map(new_map), idx(new_idx) { }
+          reference       operator*()  const { return value_type(map->keys[idx], map->vals[idx]); }
+          pointer         operator->() const { return arrow_proxy{**this}; }
+          const_iterator& operator++()       { idx++; return *this; }
+          const_iterator  operator++(int)    { const_iterator tmp = *this; ++(*this); return tmp; }
+          bool operator==(const const_iterator& other) const { return (idx == other.idx); }
+        private:
+          const MR_mapped_map* map = nullptr;
+          size_type            idx = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The iterator type.  Elements may not be modified via iterators, so this is the same as const_iterator. */
+      typedef const_iterator iterator;
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct an empty map.  Use map_file() to fill it. */
+      MR_mapped_map() = default;
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Mapping */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Map a file, and use arrays in it as the contents of the map.  Any previous contents are dropped.
+          @param file_name  Name of the file
+          @param key_offset Offset in bytes of the first key.  Must be a multiple of alignof(key_t).
+          @param val_offset Offset in bytes of the first value.  Must be a multiple of alignof(val_t).
+          @param count      Number of keys & values.  Keys must be unique & sorted in increasing order.
+          @return 0 on success, and 1 on error (the map is left empty) */
+      int map_file(std::string file_name, size_type key_offset, size_type val_offset, size_type count) {
+        *this = MR_mapped_map();
+        if (((key_offset % alignof(key_t)) != 0) || ((val_offset % alignof(val_t)) != 0)) {
+          std::cout << "ERROR(MR_mapped_map::map_file): Misaligned arrays!" << std::endl;
+          return 1;
+        }
+        auto new_region = std::make_shared<region_t>();
+        if (new_region->open(file_name)) {
+          std::cout << "ERROR(MR_mapped_map::map_file): Could not map file!" << std::endl;
+          return 1;
+        }
+        const size_type length = new_region->length;
+        if ((key_offset > length) || (val_offset > length) ||
+            (count > (length - key_offset) / sizeof(key_t)) || (count > (length - val_offset) / sizeof(val_t))) {
+          std::cout << "ERROR(MR_mapped_map::map_file): File is truncated!" << std::endl;
+          return 1;
+        }
+        region = new_region;
+        keys   = reinterpret_cast<const key_t*>(region->data + key_offset);
+        vals   = reinterpret_cast<const val_t*>(region->data + val_offset);
+        num    = count;
+        return 0;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Capacity */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements in the map */
+      inline size_type size() const { return num; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if the map holds no elements */
+      inline bool empty() const { return (num == 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of slots.  There are no empty slots, so this is size(). */
+      inline size_type bucket_count() const { return num; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Load factor.  There are no empty slots, so this is one. */
+      inline float load_factor() const { return 1.0f; }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Lookup */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if key is in the map
+          @param key Key to search for */
+      inline bool contains(const key_t& key) const { return (find_idx(key) < num); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements with the given key (0 or 1)
+          @param key Key to search for */
+      inline size_type count(const key_t& key) const { return (contains(key) ? 1 : 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find an element
+          @param key Key to search for
+          @return Iterator to the element, or cend() if key is not in the map */
+      inline const_iterator find(const key_t& key) const { return const_iterator(this, std::min(find_idx(key), num)); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element with bounds checking.
+          @param key Key to search for
+          @return Reference to the mapped value
+          @throws std::out_of_range if key is not in the map */
+      inline const val_t& at(const key_t& key) const {
+        size_type idx = find_idx(key);
+        if (idx >= num)
+          throw std::out_of_range("MR_mapped_map::at");
+        return vals[idx];
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Iterators */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline const_iterator cbegin() const { return const_iterator(this, 0);   } //!< Iterator to first element
+      inline const_iterator cend()   const { return const_iterator(this, num); } //!< Iterator past the last element
+      inline const_iterator begin()  const { return cbegin();                  } //!< Iterator to first element
+      inline const_iterator end()    const { return cend();                    } //!< Iterator past the last element
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Search Mechanics */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find the position of key with a branch free binary search.
+          @return The position, or a value greater than or equal to size() if key is not in the map. */
+      inline size_type find_idx(const key_t& key) const {
+        if ((num == 0) || (key < keys[0]) || (key > keys[num-1]))
+          return num;
+        size_type base = 0;
+        size_type len  = num;
+        while (len > 1) {
+          size_type half = len / 2;
+          base += static_cast<size_type>(keys[base + half - 1] < key) * half;
+          len  -= half;
+        }
+        if (keys[base] == key)
+          return base;
+        return num;
+      }
+      //@}
+  };
+}
+
+#undef MJR_MAPPED_MAP_MMAP
+
+#define MJR_INCLUDE_MR_mapped_map
+#endif
@@ -0,0 +1,313 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_memo_file.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_memo_file class.@EOL
+ @keywords  memoization cache persistent file
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_memo_file
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <cstring>                                                       /* std:: C string.h        C++11    */
+#include <filesystem>                                                    /* C++ filesystem          C++17    */
+#include <fstream>                                                       /* C++ fstream             C++98    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iostream>                                                      /* C++ iostream            C++11    */
+#include <string>                                                        /* C++ strings             C++11    */
+#include <type_traits>                                                   /* C++ metaprogramming     C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_flat_map.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Append only key/value file used by MR_rect_tree to remember sample function results between runs.
+
+      The file starts with a 16 byte header: the 8 byte magic string "MRMEMO01", followed by the key size & value size as 32-bit integers.  The rest of
+      the file is a sequence of fixed size records: a 64-bit context, a key, and a value -- all in native byte order.  The context identifies what the key
+      means.  MR_rect_tree uses a hash of the sample function tag, bounding box, max_level, and dimensions (see MR_rect_tree::open_memo_file()), so one file
+      may be shared by trees with different bounding boxes or different functions.
+
+      When the file is opened, every record for our context is read (using large sequential reads) into an in memory MR_flat_map.  New entries are added
+      to the map, and buffered for appending to the file.  Each flush() appends complete records with one write, so several processes may append to the
+      same file.  Records appended by other processes after we opened the file may be read with refresh().
+
+      The file is read into a map rather than memory mapped like MR_mapped_map because it grows.  This process and others append to it while it is in use,
+      so a mapping would need to be redone after every append.  Records are also not sorted by key, and several contexts share one file.
+
+      A record torn by a writer that crashed in the middle of a write is removed when the file is opened.  So don't open a file while another process may be
+      in the middle of a write to it.
+
+      @tparam key_t  The key type.  Must be trivially copyable.
+      @tparam val_t  The value type.  Must be trivially copyable.
+      @tparam hash_t The hash function object type */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_memo_file {
+
+      static_assert(std::is_trivially_copyable<key_t>::value, "MR_memo_file: key_t must be trivially copyable");
+      static_assert(std::is_trivially_copyable<val_t>::value, "MR_memo_file: val_t must be trivially copyable");
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef std::size_t size_type;        //!< Size type
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Private Constants */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static char      magic[9]         = "MRMEMO01";
+      constexpr static size_type header_size      = 16;
+      constexpr static size_type record_size      = sizeof(uint64_t) + sizeof(key_t) + sizeof(val_t);
+      constexpr static size_type read_chunk_size  = 1 << 20;     // Bytes read at once when loading
+      constexpr static size_type write_chunk_size = 1 << 16;     // Bytes buffered before a flush
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::string                      file_name;        //!< Name of the open file.  Empty if no file is open.
+      uint64_t                         context = 0;      //!< Context of our records
+      MR_flat_map<key_t, val_t, hash_t> entries;         //!< Entries for our context
+      std::ofstream                    out_stream;       //!< Unbuffered append stream
+      std::vector<char>                pending;          //!< Records waiting for flush()
+      std::uintmax_t                   read_offset = 0;  //!< File offset just past the last record read
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors & Destructor */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct with no open file. */
+      MR_memo_file() = default;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      MR_memo_file(const MR_memo_file&) = delete;
+      MR_memo_file& operator=(const MR_memo_file&) = delete;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Flushes pending records. */
+      ~MR_memo_file() { close(); }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name File Operations */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Open a memo file, creating it if required, and load all records for the given context.  Any open file is closed first.
+          @param new_file_name Name of the file
+          @param new_context   Context of the records we will read & write
+          @return 0 on success, and 1 on error (the memo file will be closed) */
+      int open(std::string new_file_name, uint64_t new_context) {
+        close();
+        std::error_code ec;
+        if ( !(std::filesystem::exists(new_file_name, ec))) {
+          std::ofstream hdr_stream(new_file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+          if ( !(hdr_stream.is_open())) {
+            std::cout << "ERROR(MR_memo_file::open): Could not create file!" << std::endl;
+            return 1;
+          }
+          hdr_stream.write(header().data(), header_size);
+        }
+        std::ifstream in_stream(new_file_name, std::ios::in | std::ios::binary);
+        std::vector<char> hdr(header_size);
+        if ( !(in_stream.is_open()) || !(in_stream.read(hdr.data(), header_size))) {
+          std::cout << "ERROR(MR_memo_file::open): Could not read file header!" << std::endl;
+          return 1;
+        }
+        if (hdr != header()) {
+          std::cout << "ERROR(MR_memo_file::open): Bad file header (wrong file type or wrong key/value size)!" << std::endl;
+          return 1;
+        }
+        in_stream.close();
+        std::uintmax_t file_size = std::filesystem::file_size(new_file_name, ec);
+        if (ec) {
+          std::cout << "ERROR(MR_memo_file::open): Could not get file size!" << std::endl;
+          return 1;
+        }
+        std::uintmax_t torn = (file_size - header_size) % record_size;
+        if (torn > 0) {
+          std::filesystem::resize_file(new_file_name, file_size - torn, ec);
+          if (ec) {
+            std::cout << "ERROR(MR_memo_file::open): Could not remove torn record!" << std::endl;
+            return 1;
+          }
+        }
+        out_stream.rdbuf()->pubsetbuf(nullptr, 0);
+        out_stream.open(new_file_name, std::ios::out | std::ios::binary | std::ios::app);
+        if ( !(out_stream.is_open())) {
+          std::cout << "ERROR(MR_memo_file::open): Could not open file for append!" << std::endl;
+          return 1;
+        }
+        file_name   = new_file_name;
+        context     = new_context;
+        read_offset = header_size;
+        if (refresh()) {
+          close();
+          return 1;
+        }
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Read records appended to the file since it was opened or last refreshed (perhaps by other processes).  Our own flushed records are read again,
+          which is harmless.
+          @return 0 on success, and 1 on error */
+      int refresh() {
+        if ( !(is_open()))
+          return 1;
+        std::ifstream in_stream(file_name, std::ios::in | std::ios::binary);
+        if ( !(in_stream.is_open())) {
+          std::cout << "ERROR(MR_memo_file::refresh): Could not open file!" << std::endl;
+          return 1;
+        }
+        in_stream.seekg(static_cast<std::streamoff>(read_offset));
+        std::vector<char> buf(read_chunk_size / record_size * record_size);
+        while (in_stream) {
+          in_stream.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+          size_type num_records = static_cast<size_type>(in_stream.gcount()) / record_size;
+          for(size_type i=0; i<num_records; i++) {
+            const char* rec = buf.data() + i * record_size;
+            uint64_t rec_context;
+            std::memcpy(&rec_context, rec, sizeof(uint64_t));
+            if (rec_context == context) {
+              key_t key;
+              val_t value;
+              std::memcpy(&key,   rec + sizeof(uint64_t),                 sizeof(key_t));
+              std::memcpy(&value, rec + sizeof(uint64_t) + sizeof(key_t), sizeof(val_t));
+              entries.insert_or_assign(key, value);
+            }
+          }
+          read_offset += num_records * record_size;
+          if (static_cast<size_type>(in_stream.gcount()) != num_records * record_size)
+            break;  // Partial record being written by somebody else.  We will get it next time.
+        }
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Append pending records to the file. */
+      void flush() {
+        if (is_open() && !(pending.empty())) {
+          out_stream.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+          out_stream.flush();
+          pending.clear();
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Flush pending records, close the file, and forget all entries. */
+      void close() {
+        flush();
+        if (out_stream.is_open())
+          out_stream.close();
+        file_name.clear();
+        entries.clear();
+        pending.clear();
+        read_offset = 0;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Access */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if a file is open */
+      inline bool is_open() const { return !(file_name.empty()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Name of the open file.  Empty if no file is open. */
+      inline const std::string& get_file_name() const { return file_name; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Context of our records */
+      inline uint64_t get_context() const { return context; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of entries for our context */
+      inline size_type size() const { return entries.size(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Look up a key.  Safe to call from several threads at once so long as nothing is being appended.
+          @param key   Key to look up
+          @param value Set to the value for key if key was found
+          @return true if key was found */
+      inline bool lookup(const key_t& key, val_t& value) const {
+        auto itr = entries.find(key);
+        if (itr == entries.cend())
+          return false;
+        value = itr->second;
+        return true;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Add an entry, and queue it for appending to the file.
+          @param key   Key to add
+          @param value Value to add */
+      void append(const key_t& key, const val_t& value) {
+        if ( !(is_open()))
+          return;
+        entries.insert_or_assign(key, value);
+        size_type pos = pending.size();
+        pending.resize(pos + record_size);
+        std::memcpy(pending.data() + pos,                                    &context, sizeof(uint64_t));
+        std::memcpy(pending.data() + pos + sizeof(uint64_t),                 &key,     sizeof(key_t));
+        std::memcpy(pending.data() + pos + sizeof(uint64_t) + sizeof(key_t), &value,   sizeof(val_t));
+        if (pending.size() >= write_chunk_size)
+          flush();
+      }
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name File Header */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The expected file header */
+      static std::vector<char> header() {
+        std::vector<char> hdr(header_size);
+        uint32_t key_size = sizeof(key_t);
+        uint32_t val_size = sizeof(val_t);
+        std::memcpy(hdr.data(),      magic,     8);
+        std::memcpy(hdr.data() + 8,  &key_size, 4);
+        std::memcpy(hdr.data() + 12, &val_size, 4);
+        return hdr;
+      }
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_memo_file
+#endif
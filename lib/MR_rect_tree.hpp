@@ -38,35 +38,78 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #include <algorithm>                                                     /* STL algorithm           C++11    */
 #include <array>                                                         /* array template          C++11    */
+#include <atomic>                                                        /* Atomics                 C++11    */
 #include <bit>                                                           /* STL bit manipulation    C++20    */
 #include <climits>                                                       /* std:: C limits.h        C++11    */
 #include <cmath>                                                         /* std:: C math.h          C++11    */
 #include <complex>                                                       /* Complex Numbers         C++11    */
 #include <concepts>                                                      /* Concepts library        C++20    */
+#include <condition_variable>                                            /* Condition variables     C++11    */
 #include <cstdint>                                                       /* std:: C stdint.h        C++11    */
 #include <cstring>                                                       /* std:: C string.h        C++11    */
+#include <deque>                                                         /* STL deque               C++11    */
+#include <filesystem>                                                    /* C++ filesystem          C++17    */
 #include <fstream>                                                       /* C++ fstream             C++98    */
 #include <functional>                                                    /* STL funcs               C++98    */
+#include <future>                                                        /* Futures                 C++11    */
 #include <iomanip>                                                       /* C++ stream formatting   C++11    */
 #include <iostream>                                                      /* C++ iostream            C++11    */
 #include <limits>                                                        /* C++ Numeric limits      C++11    */
+#include <memory>                                                        /* Smart pointers          C++11    */
+#include <numeric>                                                       /* STL numeric             C++11    */
+#include <ranges>                                                        /* STL ranges              C++20    */
 #include <set>                                                           /* STL set                 C++98    */
 #include <span>                                                          /* STL spans               C++20    */
 #include <sstream>                                                       /* C++ string stream       C++      */
 #include <string>                                                        /* C++ strings             C++11    */
+#include <thread>                                                        /* threads                 C++11    */
 #include <tuple>                                                         /* STL tuples              C++11    */
 #include <type_traits>                                                   /* C++ metaprogramming     C++11    */
 #include <unordered_map>                                                 /* STL hash map            C++11    */
 #include <map>                                                           /* STL map                 C++11    */
+#include <mutex>                                                         /* Mutexes                 C++11    */
 #include <utility>                                                       /* STL Misc Utilities      C++11    */
 #include <vector>                                                        /* STL vector              C++11    */
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #include "MRMathCPP.hpp"
+#include "MR_flat_map.hpp"
+#include "MR_soa_map.hpp"
+#include "MR_sharded_map.hpp"
+#include "MR_memo_file.hpp"
+#include "MR_journal_file.hpp"
+#include "MR_sorted_map.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Put everything in the mjr namespace
 namespace mjr {
+  /* Defined in MR_mapped_map.hpp (which uses OS specific headers), so include it only where a view_t or MR_rect_tree_view is used. */
+  template <class key_t, class val_t, class hash_t> class MR_mapped_map;
+
+  /** Alias for std::unordered_map with the three parameter template signature required by the store_t template parameter of MR_rect_tree.
+      This is the node based hash map MR_rect_tree used before MR_flat_map became the default sample store. */
+  template <class key_t, class val_t, class hash_t>
+  using MR_std_unordered_map = std::unordered_map<key_t, val_t, hash_t>;
+
+  /** Hash function object for packed integer coordinate tuples (MR_rect_tree::diti_t).
+
+      Packed coordinates are far from random: each component occupies a fixed bit field, and coordinates from coarse levels have many trailing zero bits in
+      every field.  So keys generated by something like MR_rect_tree::refine_grid() form a regular lattice with power of two strides.  The identity hash
+      (what std::hash provides for integers in libstdc++) maps such a lattice onto a few buckets of a power of two sized table, and even a single Fibonacci
+      multiply leaves enough linear structure that some 2D lattices cluster badly.  This is a two round multiply-xorshift finalizer -- every input bit
+      influences every output bit, and components are mixed together before the table reduces the hash. */
+  struct MR_diti_hash {
+    inline std::size_t operator()(uint64_t diti) const noexcept {
+      uint64_t h = diti;
+      h ^= h >> 32;
+      h *= UINT64_C(0xd6e8feb86659fd93);
+      h ^= h >> 32;
+      h *= UINT64_C(0xd6e8feb86659fd93);
+      h ^= h >> 32;
+      return static_cast<std::size_t>(h);
+    }
+  };
+
 /** @brief Template Class used to house an MR_rect_tree.
 
     Overview
@@ -118,19 +161,49 @@ namespace mjr {
         - ::rrpt_t & ::drpt_t (range/domain real psudo-tuple)  -- As a ::src_t when `dim==1`, and an array otherwise
     Function arguments of type "`foo_t`" are frequently called "`foo`".
 
+    Sample Storage
+    ==============
+
+    Samples are held in a map from packed integer coordinates (::diti_t) to range values (::rrpt_t).  The map type is a template parameter (`store_t`),
+    and must provide the subset of the std::unordered_map interface used by this class: contains(), at(), insert_or_assign(), erase(), size(), reserve(),
+    clear(), & const iteration over elements with `first` (key) & `second` (value) members.  As with std::unordered_map, insert_or_assign() must return
+    a pair whose `second` member is true when a new key was inserted.  Two stores are provided:
+      - MR_flat_map -- The default.  An open addressing (Robin Hood) hash table that stores samples inline in a flat array.
+      - MR_soa_map -- A structure of arrays store with one contiguous column per range component.  Best when rng_dim is large and most work looks at a
+                      single component (see get_sample_component() & get_sample_component_min()).
+      - MR_std_unordered_map -- std::unordered_map.  One heap node per sample.
+      - MR_sharded_map -- A concurrent store made of mutex protected MR_flat_map shards.  Required by the *_parallel() refiners.
+      - MR_sorted_map -- A read only store with sorted keys & packed values.  Used by freeze().
+      - MR_mapped_map -- A read only store with sorted keys & packed values in a memory mapped save() file.  Used by MR_rect_tree_view.  Include
+                         MR_mapped_map.hpp to use it.
+    Range values may be stored with less precision than they are computed with via the `rng_store_real_t` template parameter.  For example, a tree used
+    only to drive a visualization might use `double` for `spc_real_t` (so all domain computation & sample functions use `double`) and `float` for
+    `rng_store_real_t` -- roughly halving the memory required for range data.  Where the compiler supports them, the C++23 `std::float16_t` &
+    `std::bfloat16_t` types from `<stdfloat>` may be used as well.  Values are converted when stored (sample_point()) and when read (get_sample()), so the
+    rest of the API continues to use ::rrpt_t & ::src_t.  Stored values are of type ::srpt_t.
+
+    Regions that are uniformly refined (by refine_grid() for example) may be moved from the sample store into dense bricks with pack_bricks().  A brick
+    holds every sample of a fully refined cell as a flat array indexed by local integer coordinates, and the sample store keeps everything else.  All
+    sample access goes through a few private helpers that check bricks first, so bricks are transparent to the rest of the API.
+
+    The store is instantiated with MR_diti_hash as the hash function.  Use dump_sample_store_stats() to check how well samples are distributed on a real tree.
+
     Details
     =======
 
     @tparam max_level  The maximum depth of the tree -- use one minus a power of two for highest performance.
     @tparam spc_real_t The base floating type to use for both domain & range.
     @tparam dom_dim    Domain dimension.
-    @tparam rng_dim    Range dimension. */
-  template <int max_level, class spc_real_t, int dom_dim, int rng_dim>
+    @tparam rng_dim    Range dimension.
+    @tparam store_t          Map template used to store samples.
+    @tparam rng_store_real_t Floating point type used to store range values.  Defaults to spc_real_t. */
+  template <int max_level, class spc_real_t, int dom_dim, int rng_dim, template<class, class, class> class store_t = MR_flat_map, class rng_store_real_t = spc_real_t>
   requires ((max_level>0)                                  &&
             (dom_dim>0)                                    &&
             (rng_dim>0)                                    &&
             (dom_dim*max_level<=CHAR_BIT*sizeof(uint64_t)) &&
-            (std::is_floating_point<spc_real_t>::value))
+            (std::is_floating_point<spc_real_t>::value)    &&
+            (std::is_floating_point<rng_store_real_t>::value))
   class MR_rect_tree {
     public:
 
@@ -150,10 +223,13 @@ namespace mjr {
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Externally exposed typedef for spc_real_t */
-      typedef MR_rect_tree<max_level, spc_real_t, dom_dim, rng_dim> this_t;
+      typedef MR_rect_tree<max_level, spc_real_t, dom_dim, rng_dim, store_t, rng_store_real_t> this_t;
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Externally exposed typedef for spc_real_t */
       typedef spc_real_t src_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Externally exposed typedef for rng_store_real_t */
+      typedef rng_store_real_t srt_t;
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -192,6 +268,14 @@ namespace mjr {
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** A nicely descriptive typedef for rrpt_t */
       typedef rrpt_t real_range_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** An std::array for stored range values. */
+      typedef std::array<srt_t, rng_dim> srta_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** For stored range values.  Same as rrpt_t unless rng_store_real_t differs from spc_real_t.
+            - When rng_dim==1, this will be srt_t
+            - When rng_dim!=1, this will be a srta_t (an std::array) */
+      typedef typename std::conditional<std::cmp_equal(rng_dim, 1), srt_t, srta_t>::type srpt_t;
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -249,6 +333,18 @@ namespace mjr {
       /** A std::vector used to pass lists of diti_t types around.  */
       typedef std::vector<diti_t> diti_list_t;
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Fixed size list of the 2^dom_dim corners (or children) of a cell.  Returned by the allocation free *_array functions. */
+      typedef std::array<diti_t, (1 << dom_dim)> diti_corners_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Fixed size list of the 2^(dom_dim-1) corners (or children) on one face of a cell.  Returned by the allocation free *_array functions. */
+      typedef std::array<diti_t, (1 << (dom_dim-1))> diti_face_corners_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Fixed size list of the 2^dom_dim+1 vertexes (corners and center) of a cell.  Returned by the allocation free *_array functions. */
+      typedef std::array<diti_t, (1 << dom_dim)+1> diti_vertexes_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Fixed capacity list of the up to 2*dom_dim axis aligned cross points (or neighbors) of a point.  Used by the allocation free *_array functions. */
+      typedef std::array<diti_t, 2*dom_dim> diti_axis_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       constexpr static dic_t dic_max = (static_cast<dic_t>(1) << max_level);     //!< Maximum allowd for a dic_t
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       constexpr static dic_t dic_ctr = (static_cast<dic_t>(1) << (max_level-1)); //!< Center value for a dic_t
@@ -257,7 +353,184 @@ namespace mjr {
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-      /** @name Function Types */
+      /** @name Leaf Cell Ranges
+
+          Lazy alternatives to get_leaf_cells() for use in range-for loops & std::ranges algorithms.  Leaves are visited in get_leaf_cells() order, and no
+          list of cells is built.  Ranges without a level_max or a subtree predicate scan the leaf index (see get_leaf_cells()) in place.  Other ranges walk
+          the tree depth first with an explicit stack (no recursion), so cells at level_max and pruned subtrees cost nothing.  See leaves() &
+          leaves_pred().
+
+          A range may also carry a subtree predicate.  It is evaluated on internal cells, and subtrees for which it is false are skipped without being
+          walked.  It must be conservative: false only if no leaf below the cell can match the leaf predicate.  With a selective subtree predicate a
+          query costs O(output + depth) instead of O(tree).  See leaves_pruned() & the subtree_* geometric predicates. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Predicate accepting every cell.  The default leaf & subtree predicate for leaf_range_t. */
+      struct leaf_any_t {
+        bool operator()(diti_t) const { return true; }
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      template <class cell_pred_t, class subtree_pred_t> class leaf_range_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @brief Constant forward iterator over the leaf cells of a leaf_range_t.
+          Iterators hold a pointer to their range, and so are only valid while the range exists.  An iterator scanning the leaf index holds two pointers
+          into it, and one walking the tree holds a stack of at most 2^dom_dim-1 cells per level above the current leaf -- so a copy costs at most a small
+          allocation proportional to the depth of the current leaf. */
+      template <class cell_pred_t, class subtree_pred_t>
+      class leaf_citr_t {
+        public:
+          typedef std::forward_iterator_tag iterator_category;
+          typedef diti_t                    value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef const diti_t*             pointer;
+          typedef diti_t                    reference;
+          leaf_citr_t() = default;
+          leaf_citr_t(const leaf_range_t<cell_pred_t, subtree_pred_t>* new_range, diti_t cell) : range(new_range) {
+            bool use_index = false;
+            if constexpr (std::is_same_v<subtree_pred_t, leaf_any_t>)
+              use_index = ((range->level_max < 0) && !(range->tree->leaf_index.refining) && range->tree->cell_has_child(cell));
+            if (use_index) {
+              std::tie(index_cur, index_last) = range->tree->leaf_index_span(cell);
+            } else {
+              stack.push_back(cell);
+            }
+            advance();
+          }
+          reference    operator*()  const { return cur; }
+          leaf_citr_t& operator++()       { advance(); return *this; }
+          leaf_citr_t  operator++(int)    { leaf_citr_t tmp = *this; ++(*this); return tmp; }
+          /* Iterators past the end are equal.  Others are equal when they are at the same cell in the same traversal state. */
+          bool operator==(const leaf_citr_t& other) const {
+            if ((cur == 0) || (other.cur == 0))
+              return (cur == other.cur);
+            return ((cur == other.cur) && (index_cur == other.index_cur) && (stack.size() == other.stack.size()));
+          }
+        private:
+          /* Find the next matching leaf.  With a leaf index range, scan it.  Otherwise pop cells from the stack.  Children are pushed in reverse so they
+             are popped in ccc_get_children_array() order.  Internal cells failing the subtree predicate are dropped with their whole subtree. */
+          void advance() {
+            const MR_rect_tree& tree = *(range->tree);
+            if (index_cur != nullptr) {
+              while (index_cur != index_last) {
+                diti_t c = *index_cur++;
+                if (((range->level_min <= 0) || (static_cast<int>(tree.ccc_cell_level(c)) >= range->level_min)) && range->pred(c)) {
+                  cur = c;
+                  return;
+                }
+              }
+              cur = 0;
+              return;
+            }
+            while ( !(stack.empty())) {
+              diti_t c     = stack.back();
+              int    level = static_cast<int>(tree.ccc_cell_level(c));
+              stack.pop_back();
+              if (tree.cell_has_child(c)) {
+                if (((range->level_max < 0) || (level < range->level_max)) && range->subtree_pred(c)) {
+                  diti_corners_t children = tree.ccc_get_children_array(c);
+                  for(int i=(1 << dom_dim)-1; i>=0; i--)
+                    stack.push_back(children[i]);
+                }
+              } else if ((level >= range->level_min) && range->pred(c)) {
+                cur = c;
+                return;
+              }
+            }
+            cur = 0;
+          }
+          const leaf_range_t<cell_pred_t, subtree_pred_t>* range      = nullptr;
+          const diti_t*                                    index_cur  = nullptr;  // Leaf index scan position.  nullptr if the tree is walked instead.
+          const diti_t*                                    index_last = nullptr;
+          diti_list_t                                      stack;                 // Cells still to visit when walking the tree
+          diti_t                                           cur        = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @brief A range of the leaf cells of a cell with a level in [level_min, level_max] for which a predicate is true.
+          Cells at level_max, and internal cells for which subtree_pred is false, are not descended into, so leaves below them cost nothing.  The tree
+          must not be refined while an iterator is in use.  A range may be kept while the tree is refined -- each begin() sees the current tree. */
+      template <class cell_pred_t = leaf_any_t, class subtree_pred_t = leaf_any_t>
+      class leaf_range_t {
+        public:
+          leaf_range_t(const MR_rect_tree* new_tree, diti_t new_cell, int new_level_min, int new_level_max, cell_pred_t new_pred, subtree_pred_t new_subtree_pred = subtree_pred_t())
+            : tree(new_tree), cell(new_cell), level_min(new_level_min), level_max(new_level_max), pred(std::move(new_pred)), subtree_pred(std::move(new_subtree_pred)) { }
+          leaf_citr_t<cell_pred_t, subtree_pred_t> begin() const { return leaf_citr_t<cell_pred_t, subtree_pred_t>(this, cell); }
+          leaf_citr_t<cell_pred_t, subtree_pred_t> end()   const { return leaf_citr_t<cell_pred_t, subtree_pred_t>(); }
+        private:
+          friend class leaf_citr_t<cell_pred_t, subtree_pred_t>;
+          const MR_rect_tree* tree;
+          diti_t              cell;
+          int                 level_min;
+          int                 level_max;
+          cell_pred_t         pred;
+          subtree_pred_t      subtree_pred;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The leaf_range_t returned by leaves_pruned() */
+      template <class cell_pred_t, class subtree_pred_t>
+      using pruned_leaf_range_t = leaf_range_t<std::decay_t<cell_pred_t>, std::decay_t<subtree_pred_t>>;
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Sample Storage */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Map type used to hold samples. */
+      typedef store_t<diti_t, srpt_t, MR_diti_hash> sample_store_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Constant iterator type for the sample store. */
+      typedef typename sample_store_t::const_iterator store_citr_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @brief Constant forward iterator over all samples -- first the sample store, and then any dense bricks (see pack_bricks()).
+          Elements are `std::pair<diti_t, srpt_t>` returned by value. */
+      class sample_citr_t {
+        public:
+          /** Holds an element so that operator->() has something to point at. */
+          struct arrow_proxy {
+            std::pair<diti_t, srpt_t> elt;
+            const std::pair<diti_t, srpt_t>* operator->() const { return &elt; }
+          };
+          typedef std::forward_iterator_tag iterator_category;
+          typedef std::pair<diti_t, srpt_t> value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef arrow_proxy               pointer;
+          typedef value_type                reference;
+          sample_citr_t() = default;
+          sample_citr_t(const MR_rect_tree* new_tree, store_citr_t new_sitr, std::size_t new_slot) : tree(new_tree), sitr(new_sitr), slot(new_slot) { skip_unused(); }
+          reference      operator*()  const {
+            if (sitr != tree->samples.cend())
+              return value_type(sitr->first, sitr->second);
+            else
+              return value_type(tree->brick_slot_to_diti(slot), tree->brick_vals[slot]);
+          }
+          pointer        operator->() const { return arrow_proxy{**this}; }
+          sample_citr_t& operator++()       { if (sitr != tree->samples.cend()) ++sitr; else slot++; skip_unused(); return *this; }
+          sample_citr_t  operator++(int)    { sample_citr_t tmp = *this; ++(*this); return tmp; }
+          bool operator==(const sample_citr_t& other) const { return ((sitr == other.sitr) && (slot == other.slot)); }
+        private:
+          void skip_unused() {
+            if (sitr == tree->samples.cend())
+              while ((slot < tree->brick_vals.size()) && ( !(tree->brick_slot_is_used(slot))))
+                slot++;
+          }
+          const MR_rect_tree* tree = nullptr;
+          store_citr_t        sitr;
+          std::size_t         slot = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Type returned by freeze() -- this tree type with an MR_sorted_map sample store. */
+      typedef MR_rect_tree<max_level, spc_real_t, dom_dim, rng_dim, MR_sorted_map, rng_store_real_t> frozen_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Type used to view save() files written by this tree type without reading them -- this tree type with an MR_mapped_map sample store.  See load().
+          Include MR_mapped_map.hpp to use it. */
+      typedef MR_rect_tree<max_level, spc_real_t, dom_dim, rng_dim, MR_mapped_map, rng_store_real_t> view_t;
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Function Types
+
+          These std::function types document the signatures of the functions passed to the sampling, refinement, & predicate members.  Those members are
+          templates accepting any invocable with a matching signature (lambdas, function pointers, function objects, or these std::function types), so
+          simple sample functions and predicates may be inlined into the refinement loops. */
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Real input sample function */
@@ -271,6 +544,21 @@ namespace mjr {
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Real input, single real variable output function */
       typedef std::function<src_t(drpt_t)>  drpt2real_func_t;      //  dr2r (Domain Point SDF)
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** A block of domain points in structure of arrays form.  Element i is a span holding the i'th component of every point. */
+      typedef std::array<std::span<const src_t>, dom_dim> drpt_batch_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** A block of range points in structure of arrays form.  Element i is a span to be filled with the i'th component of every result. */
+      typedef std::array<std::span<src_t>, rng_dim>       rrpt_batch_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch sample function.  Computes the function at every point in the first argument, and stores the results in the second argument.  All spans
+          in both arguments have the same length.  See refine_grid(), refine_once(), & the refine_*_cell_pred() members. */
+      typedef std::function<void(const drpt_batch_t&, const rrpt_batch_t&)> drpt2rrpt_batch_func_t;       // dr2rr (Batch Sample Function)
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async sample function.  Starts computing the function at a point, and returns a future whose get() yields the value (a ::rrpt_t, or anything
+          convertible to one).  get() is called exactly once, on the calling thread.  Any type with such a get() member may be returned -- std::future is
+          only the most common.  See the *_async() refinement members. */
+      typedef std::function<std::future<rrpt_t>(drpt_t)>                     drpt2rrpt_async_func_t;       // dr2rr (Async Sample Function)
       //@}
 
     private:
@@ -282,6 +570,45 @@ namespace mjr {
       constexpr static diti_t diti_ones = ~static_cast<diti_t>(0);                         // diti_t int with all ones
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       constexpr static diti_t diti_msk0 = static_cast<diti_t>(~(diti_ones << dic_bits));   // diti_t int with ones on 0th coord
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Sum of unit tuples for the axes with a set bit in the given mask -- i.e. a tuple with a component of 1 on each axis in the mask, & 0 elsewhere. */
+      constexpr static diti_t diti_units(int mask) {
+        diti_t rv = 0;
+        for(int j=0; j<dom_dim; j++)
+          if ((mask >> j) & 1)
+            rv |= static_cast<diti_t>(static_cast<diti_t>(1) << (dic_bits * j));
+        return rv;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static diti_t diti_all_units = diti_units((1 << dom_dim) - 1);                 // diti_t int with a one in every coord
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Offset patterns for cuc_two_cross_array().  Element i has a one in coord j if bit j of i is set.  Corner i is diti-delta*ones+2*delta*pattern[i] */
+      constexpr static std::array<diti_t, (1 << dom_dim)> two_cross_patterns = [] {
+        std::array<diti_t, (1 << dom_dim)> rv;
+        for(int i=0; i<(1 << dom_dim); i++)
+          rv[i] = diti_units(i);
+        return rv;
+      }();
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Offset patterns for directional cuc_two_cross_array().  face_cross_patterns[index][(direction+1)/2] is the subset of two_cross_patterns on that face. */
+      constexpr static std::array<std::array<std::array<diti_t, (1 << (dom_dim-1))>, 2>, dom_dim> face_cross_patterns = [] {
+        std::array<std::array<std::array<diti_t, (1 << (dom_dim-1))>, 2>, dom_dim> rv;
+        for(int index=0; index<dom_dim; index++)
+          for(int dir=0; dir<2; dir++)
+            for(int i=0, k=0; i<(1 << dom_dim); i++)
+              if (((i >> index) & 1) == dir)
+                rv[index][dir][k++] = diti_units(i);
+        return rv;
+      }();
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Masks used by locate_leaf() & ccc_get_coarse_neighbor_leaf().  Clearing the bits of a point with level_cell_masks[level], and then adding
+         diti_all_units times the half width of a cell at that level, gives the center of the cell at that level holding the point. */
+      constexpr static std::array<diti_t, max_level> level_cell_masks = [] {
+        std::array<diti_t, max_level> rv;
+        for(int level=0; level<max_level; level++)
+          rv[level] = static_cast<diti_t>(diti_all_units * static_cast<diti_t>(diti_msk0 & ~static_cast<diti_t>((static_cast<diti_t>(2) << (max_level-1-level)) - 1)));
+        return rv;
+      }();
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -292,7 +619,925 @@ namespace mjr {
       drpt_t bbox_max;      //!< Holds the maximal point for the real domain range
       drpt_t bbox_delta;    //!< The wdith of the real domain range
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
-      std::unordered_map<diti_t, rrpt_t> samples; //!< Holds the sampled data
+      sample_store_t samples; //!< Holds the sampled data
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      int                  brick_level = 0;          //!< Level of brick cells
+      int                  brick_depth = 0;          //!< Bricks hold all samples of cells this many levels below brick_level
+      std::vector<int32_t> brick_dir;                //!< Brick number for every cell at brick_level (-1 if not a brick)
+      std::vector<diti_t>  brick_origins;            //!< Minimum corner for each brick
+      std::vector<srpt_t>  brick_vals;               //!< Sample values for all bricks.  brick_nslot values per brick
+      std::vector<bool>    brick_canon;              //!< True for the slots of brick_vals holding the canonical copy of their point
+      std::size_t          brick_nslot = 0;          //!< Number of values stored per brick
+      std::size_t          brick_ncrn = 0;           //!< Number of values in the corner grid of a brick
+      std::size_t          brick_sample_count = 0;   //!< Number of samples held in bricks
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Dense Brick Helpers
+
+          A brick covers one cell at brick_level, and holds every sample of that cell down to level brick_level+brick_depth.  The samples of a brick are
+          stored as two dense grids: the (n+1)^dom_dim corner grid followed by the n^dom_dim center grid, where n=2^brick_depth.  Adjacent bricks both store
+          the points on their shared faces.  The copy found first by brick_slot() is canonical, and all copies are updated by sample_put().  pack_bricks()
+          records the canonical slots in brick_canon, so sample iteration need not search for them. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static std::size_t brick_npos = std::numeric_limits<std::size_t>::max();   // Returned by brick_slot() for points not in a brick
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Number of points on one side of the brick corner grid. */
+      inline std::size_t brick_side() const { return (static_cast<std::size_t>(1) << brick_depth) + 1; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Compute the slots in brick_vals holding a point.  The canonical slot is first.  When all_copies is false at most one slot is returned.
+         @return Number of slots found. */
+      template<bool all_copies>
+      int brick_find_slots(diti_t diti, std::array<std::size_t, (1 << dom_dim)>& slots) const {
+        if (brick_dir.empty())
+          return 0;
+        const int         wbits = max_level - brick_level;      // log2 of brick width
+        const int         sbits = wbits - brick_depth;          // log2 of finest cell width
+        const std::size_t bwid  = static_cast<std::size_t>(1) << wbits;
+        const std::size_t hwid  = static_cast<std::size_t>(1) << (sbits - 1);
+        const std::size_t smsk  = (static_cast<std::size_t>(1) << sbits) - 1;
+        const std::size_t nb    = static_cast<std::size_t>(1) << brick_level;
+        const std::size_t side  = brick_side();
+        std::array<std::size_t, dom_dim> b, l;
+        std::size_t rem = 0;
+        for(int i=0; i<dom_dim; i++) {
+          std::size_t c = cuc_get_crd(diti, i);
+          b[i] = std::min(c >> wbits, nb-1);
+          l[i] = c - b[i] * bwid;
+          std::size_t r = l[i] & smsk;
+          if ( (r != 0) && (r != hwid) )
+            return 0;
+          if ( (i > 0) && (r != rem) )
+            return 0;
+          rem = r;
+        }
+        if (rem != 0) {
+          std::size_t dir_idx = 0, loc = 0;
+          for(int i=dom_dim-1; i>=0; i--) {
+            dir_idx = dir_idx * nb         + b[i];
+            loc     = loc     * (side - 1) + (l[i] >> sbits);
+          }
+          int32_t id = brick_dir[dir_idx];
+          if (id < 0)
+            return 0;
+          slots[0] = static_cast<std::size_t>(id) * brick_nslot + brick_ncrn + loc;
+          return 1;
+        }
+        int num_alt = 0;
+        std::array<int, dom_dim> alt_idx;
+        for(int i=0; i<dom_dim; i++)
+          if ((l[i] == 0) && (b[i] > 0))
+            alt_idx[num_alt++] = i;
+        int num_found = 0;
+        for(int m=0; m<(1 << num_alt); m++) {
+          std::array<std::size_t, dom_dim> bm = b, lm = l;
+          for(int j=0; j<num_alt; j++) {
+            if ((m >> j) & 1) {
+              bm[alt_idx[j]] -= 1;
+              lm[alt_idx[j]]  = bwid;
+            }
+          }
+          std::size_t dir_idx = 0, loc = 0;
+          for(int i=dom_dim-1; i>=0; i--) {
+            dir_idx = dir_idx * nb   + bm[i];
+            loc     = loc     * side + (lm[i] >> sbits);
+          }
+          int32_t id = brick_dir[dir_idx];
+          if (id >= 0) {
+            slots[num_found++] = static_cast<std::size_t>(id) * brick_nslot + loc;
+            if constexpr ( !(all_copies))
+              return num_found;
+          }
+        }
+        return num_found;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Canonical slot in brick_vals for a point, or brick_npos if the point is not in a brick. */
+      inline std::size_t brick_slot(diti_t diti) const {
+        std::array<std::size_t, (1 << dom_dim)> slots;
+        return (brick_find_slots<false>(diti, slots) > 0 ? slots[0] : brick_npos);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Point stored at the given local index of a brick with the given minimum corner. */
+      diti_t brick_local_to_diti(diti_t origin, std::size_t local) const {
+        const std::size_t side = brick_side();
+        const dic_t       wid  = static_cast<dic_t>(dic_max >> (brick_level + brick_depth));
+        std::size_t rad  = side;
+        dic_t       offs = 0;
+        if (local >= brick_ncrn) {
+          local -= brick_ncrn;
+          rad    = side - 1;
+          offs   = wid / 2;
+        }
+        diti_t rv = origin;
+        for(int i=0; i<dom_dim; i++) {
+          rv = cuc_inc_crd(rv, i, static_cast<dic_t>(static_cast<dic_t>(local % rad) * wid + offs));
+          local /= rad;
+        }
+        return rv;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Point stored in a slot of brick_vals. */
+      inline diti_t brick_slot_to_diti(std::size_t slot) const {
+        return brick_local_to_diti(brick_origins[slot / brick_nslot], slot % brick_nslot);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* True if a slot of brick_vals is the canonical copy of its point. */
+      inline bool brick_slot_is_used(std::size_t slot) const {
+        return brick_canon[slot];
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Call func(diti, srpt) for the canonical copy of each point held in bricks. */
+      template<class func_t>
+      void for_each_brick_sample(func_t func) const {
+        for(std::size_t slot=0; slot<brick_vals.size(); slot++)
+          if (brick_slot_is_used(slot))
+            func(brick_slot_to_diti(slot), brick_vals[slot]);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Point has been sampled -- in a brick or in the sample store. */
+      inline bool sample_exists(diti_t diti) const {
+        return ((brick_slot(diti) != brick_npos) || samples.contains(diti));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Sample value for a point.  The point must exist. */
+      inline srpt_t sample_get(diti_t diti) const {
+        std::size_t slot = brick_slot(diti);
+        if (slot != brick_npos)
+          return brick_vals[slot];
+        return samples.at(diti);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* True if the sample store supports concurrent once-only inserts (MR_sharded_map). */
+      constexpr static bool store_is_concurrent = requires(sample_store_t& s, diti_t d) { s.try_emplace_with(d, []() { return srpt_t(); }); };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Store a sample value.  Points covered by bricks are updated in every brick holding them, and other points go to the sample store.  Points in
+         bricks always have samples, so only a new key in the store can be a new cell for the leaf index.  The sample is also added to the journal, if
+         one is open. */
+      inline void sample_put(diti_t diti, const srpt_t& val) {
+        std::array<std::size_t, (1 << dom_dim)> slots;
+        int num_slots = brick_find_slots<true>(diti, slots);
+        if (num_slots > 0) {
+          for(int i=0; i<num_slots; i++)
+            brick_vals[slots[i]] = val;
+        } else if (samples.insert_or_assign(diti, val).second && leaf_index.valid && cell_good_center(diti)) {
+          leaf_index_note_cell(diti);
+        }
+        if (journal.file)
+          journal.file->append(diti, val);
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Memo File Helpers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef MR_memo_file<diti_t, srpt_t, MR_diti_hash> memo_file_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Holds the memo file.  MR_memo_file::append() & flush() are not thread safe, so copies of a tree start without a memo file (copies refined on
+         other threads would race on it), and assigning to a tree closes its memo file. */
+      struct memo_holder_t {
+        std::unique_ptr<memo_file_t> file;
+        memo_holder_t() = default;
+        memo_holder_t(const memo_holder_t&) { }
+        memo_holder_t(memo_holder_t&&) = default;
+        memo_holder_t& operator=(const memo_holder_t&) { file.reset(); return *this; }
+        memo_holder_t& operator=(memo_holder_t&&) = default;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      memo_holder_t memo;                //!< Memo file of sample function results.  Not shared with copies.  See open_memo_file().
+      std::string   memo_tag;            //!< Tag naming the sample function for the memo file
+      std::size_t   memo_hit_count = 0;  //!< Number of samples taken from the memo file
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Memo & journal file context for this tree -- a hash (FNV-1a) of a tag, max_level, dimensions, value sizes, and bounding box. */
+      uint64_t file_context(const std::string& tag) const {
+        uint64_t h   = UINT64_C(14695981039346656037);
+        auto     mix = [&h](const void* data, std::size_t size) {
+          for(std::size_t i=0; i<size; i++) {
+            h ^= static_cast<const unsigned char*>(data)[i];
+            h *= UINT64_C(1099511628211);
+          }
+        };
+        const int dims[5] = {max_level, dom_dim, rng_dim, static_cast<int>(sizeof(src_t)), static_cast<int>(sizeof(srpt_t))};
+        mix(tag.data(),      tag.size());
+        mix(dims,            sizeof(dims));
+        mix(&bbox_min,       sizeof(drpt_t));
+        mix(&bbox_max,       sizeof(drpt_t));
+        return h;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Look up a point in the memo file (if one is open), and count the hit. */
+      inline bool memo_lookup(diti_t diti, srpt_t& val) {
+        if (memo.file && memo.file->lookup(diti, val)) {
+          memo_hit_count++;
+          return true;
+        }
+        return false;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Add a new sample to the memo file (if one is open). */
+      inline void memo_append(diti_t diti, const srpt_t& val) {
+        if (memo.file)
+          memo.file->append(diti, val);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Store samples for points found in the memo file, and return the other points. */
+      diti_list_t memo_filter(std::span<const diti_t> keys) {
+        diti_list_t misses;
+        for(auto k: keys) {
+          srpt_t val;
+          if (memo_lookup(k, val))
+            sample_put(k, val);
+          else
+            misses.push_back(k);
+        }
+        return misses;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Journal Helpers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef MR_journal_file<diti_t, srpt_t> journal_file_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Holds the journal.  Copies of a tree start without a journal, and assigning to a tree closes its journal.  resumed is true when the journal was
+         opened by resume_from_journal() -- refine_grid() then skips points that already have samples.  A bounding box change drops the file, but not resumed. */
+      struct journal_holder_t {
+        std::unique_ptr<journal_file_t> file;
+        bool                            resumed = false;
+        journal_holder_t() = default;
+        journal_holder_t(const journal_holder_t&) { }
+        journal_holder_t(journal_holder_t&&) = default;
+        journal_holder_t& operator=(const journal_holder_t&) { file.reset(); resumed = false; return *this; }
+        journal_holder_t& operator=(journal_holder_t&&) = default;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      journal_holder_t journal;  //!< Journal of new samples.  See open_journal().
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Leaf Index Helpers
+
+          Once built, the leaf cells are kept up to date as samples are stored, so get_leaf_cells() is a scan of a sorted array and count_leaf_cells() of the
+          top cell is O(1).  A cell exists when its center has been sampled, and is a leaf when its "lower left" child does not exist (see cell_has_child()).
+          So sample_put() only acts when a new sample is a cell center (see cell_good_center()): the new cell is a leaf unless its lower left child exists,
+          and when the new cell is the lower left child of an existing cell that cell is no longer a leaf.  This works for samples stored in any order.
+
+          Changes are collected in adds & dels, and merged into cells by the next query.  Stores filled without sample_put() (load(), the constructor adopting
+          a store, & the parallel task refiners) invalidate the index, and it is rebuilt by walking the tree on the next query.  While the parallel task
+          refiners run, queries (by their predicates for example) walk the tree without building the index -- other threads are still adding samples.
+
+          The index starts out invalid, and sample_put() only maintains it once a leaf query has built it.  The store write reports if a key is new, so only
+          new keys pay a cell_good_center() test, and only new cells pay a child probe (plus a parent probe for "lower left" children).  The refiners that
+          start from get_leaf_cells() build the index, so this is the normal cost of adaptive refinement -- around 20% of refinement time with a cheap
+          sample function in 2D.  Refining a full grid after a leaf query costs more (around 75%), because every third sample is a new cell.  Runs that
+          never ask for leaves pay nothing. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      struct leaf_index_t {
+        diti_list_t cells;          // Leaf cells in get_leaf_cells() order -- see leaf_index_less()
+        diti_list_t adds;           // New leaf cells not yet merged into cells
+        diti_list_t dels;           // Leaf cells that have been split, but not yet removed from cells
+        std::size_t count = 0;      // Number of leaf cells
+        bool        valid = false;  // If false, then everything above must be rebuilt (and sample_put() leaves it alone)
+        bool        refining = false;  // True while the parallel task refiners run.  Queries then walk the tree, and the index is left invalid.  Not copied.
+        mutable std::mutex lock;    // Serializes merges by concurrent queries, and copies of the index
+        leaf_index_t() = default;
+        leaf_index_t(const leaf_index_t& other) {
+          std::lock_guard<std::mutex> guard(other.lock);
+          cells = other.cells; adds = other.adds; dels = other.dels; count = other.count; valid = other.valid;
+        }
+        leaf_index_t(leaf_index_t&& other) : cells(std::move(other.cells)), adds(std::move(other.adds)), dels(std::move(other.dels)), count(other.count), valid(other.valid) { }
+        leaf_index_t& operator=(const leaf_index_t& other) {
+          if (this != &other) {
+            std::scoped_lock guard(lock, other.lock);
+            cells = other.cells; adds = other.adds; dels = other.dels; count = other.count; valid = other.valid;
+          }
+          return *this;
+        }
+        leaf_index_t& operator=(leaf_index_t&& other) {
+          cells = std::move(other.cells); adds = std::move(other.adds); dels = std::move(other.dels); count = other.count; valid = other.valid; return *this;
+        }
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      mutable leaf_index_t leaf_index;  //!< Leaf cells.  See get_leaf_cells().
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Strict order on cells matching the order of get_leaf_cells(): Morton order of the minimum corners with axis dom_dim-1 most significant (the order
+         of ccc_get_children_array()), and larger cells first when minimum corners are equal. */
+      bool leaf_index_less(diti_t a, diti_t b) const {
+        const diti_t ca = ccc_cell_get_corner_min(a);
+        const diti_t cb = ccc_cell_get_corner_min(b);
+        if (ca == cb)
+          return (ccc_cell_half_width(a) > ccc_cell_half_width(b));
+        int   axis    = dom_dim - 1;
+        dic_t top_xor = 0;
+        for(int i=dom_dim-1; i>=0; i--) {
+          dic_t x = static_cast<dic_t>(cuc_get_crd(ca, i) ^ cuc_get_crd(cb, i));
+          if ((top_xor < x) && (top_xor < static_cast<dic_t>(top_xor ^ x))) {  // x has a higher most significant bit than top_xor
+            top_xor = x;
+            axis    = i;
+          }
+        }
+        return (cuc_get_crd(ca, axis) < cuc_get_crd(cb, axis));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Update the leaf index for a new cell.  Called by sample_put() after the cell center is stored. */
+      void leaf_index_note_cell(diti_t cell) {
+        if ( !(cell_has_child(cell))) {
+          leaf_index.adds.push_back(cell);
+          leaf_index.count++;
+        }
+        const int level = static_cast<int>(ccc_cell_level(cell));
+        if (level > 0) {
+          const dic_t  hw     = ccc_cell_half_width(cell);
+          const diti_t parent = static_cast<diti_t>((cell & level_cell_masks[level-1]) + diti_all_units * static_cast<diti_t>(2 * hw));
+          if ((cell == cuc_dec_all_crd(parent, hw)) && vertex_exists(parent)) {
+            leaf_index.dels.push_back(parent);
+            leaf_index.count--;
+          }
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Bring leaf_index.cells up to date -- rebuilding it if it is invalid.  leaf_index.lock must be held. */
+      void leaf_index_sync() const {
+        if ( !(leaf_index.valid)) {
+          leaf_index.cells.clear();
+          leaf_index.adds.clear();
+          leaf_index.dels.clear();
+          if (cell_exists(ccc_get_top_cell()))
+            append_leaf_cells(ccc_get_top_cell(), leaf_index.cells);
+          leaf_index.count = leaf_index.cells.size();
+          leaf_index.valid = true;
+        } else if ( !(leaf_index.adds.empty() && leaf_index.dels.empty())) {
+          auto less = [this](diti_t a, diti_t b) { return leaf_index_less(a, b); };
+          std::sort(leaf_index.adds.begin(), leaf_index.adds.end(), less);
+          std::sort(leaf_index.dels.begin(), leaf_index.dels.end(), less);
+          diti_list_t merged;
+          merged.reserve(leaf_index.cells.size() + leaf_index.adds.size());
+          std::merge(leaf_index.cells.cbegin(), leaf_index.cells.cend(), leaf_index.adds.cbegin(), leaf_index.adds.cend(), std::back_inserter(merged), less);
+          leaf_index.cells.clear();
+          std::set_difference(merged.cbegin(), merged.cend(), leaf_index.dels.cbegin(), leaf_index.dels.cend(), std::back_inserter(leaf_index.cells), less);
+          leaf_index.adds.clear();
+          leaf_index.dels.clear();
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* The range of leaf_index.cells inside the given cell.  leaf_index.lock must be held, and leaf_index_sync() called. */
+      std::pair<typename diti_list_t::const_iterator, typename diti_list_t::const_iterator> leaf_index_range(diti_t cell) const {
+        const diti_t corner = ccc_cell_get_corner_min(cell);
+        const diti_t mask   = level_cell_masks[ccc_cell_level(cell)];
+        auto first = std::lower_bound(leaf_index.cells.cbegin(), leaf_index.cells.cend(), cell, [this](diti_t a, diti_t b) { return leaf_index_less(a, b); });
+        auto last  = std::find_if(first, leaf_index.cells.cend(), [this, corner, mask](diti_t c) { return ((ccc_cell_get_corner_min(c) & mask) != corner); });
+        return {first, last};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* The leaf cells of the given internal cell as a span of leaf_index.cells -- the index is brought up to date first.  The span is valid until the
+         tree is next modified. */
+      std::pair<const diti_t*, const diti_t*> leaf_index_span(diti_t cell) const {
+        std::lock_guard<std::mutex> guard(leaf_index.lock);
+        leaf_index_sync();
+        if (cell == ccc_get_top_cell())
+          return {leaf_index.cells.data(), leaf_index.cells.data() + leaf_index.cells.size()};
+        auto [first, last] = leaf_index_range(cell);
+        return {std::to_address(first), std::to_address(last)};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Mark the leaf index for a rebuild.  Used after samples are stored without sample_put(). */
+      void leaf_index_invalidate() {
+        leaf_index.valid = false;
+        leaf_index.cells.clear();
+        leaf_index.adds.clear();
+        leaf_index.dels.clear();
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Sampling Helpers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::size_t sample_batch_size = 1024;   //!< Maximum number of points passed to a batch sample function in one call
+      int         thread_count      = 1;      //!< Number of threads used to evaluate sample functions
+      std::size_t async_window      = 64;     //!< Maximum number of async sample function evaluations in flight
+      int         balance_delta     = -1;     //!< Level delta kept by the scalar predicate refiners (see set_balance_delta()).  Negative means off.
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static std::size_t parallel_tile_size       = 1 << 16;   // Number of points collected before a parallel evaluation
+      constexpr static std::size_t parallel_min_thread_work = 256;       // Minimum number of points given to one thread
+      constexpr static int         parallel_task_grain      = 3;         // Subtrees within this many levels of the level limit are not split into tasks
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Reserve space in the sample store for a uniform grid in a cell.  See refine_grid(). */
+      void reserve_grid_samples(int level_delta) {
+        if constexpr (dom_dim <= 3) {
+          std::size_t num_corners = 1;
+          std::size_t num_centers = 1;
+          for(int i=0; i<dom_dim; i++) {
+            num_corners *= (static_cast<std::size_t>(1) << level_delta) + 1;
+            num_centers *= (static_cast<std::size_t>(1) << level_delta);
+          }
+          samples.reserve(samples.size() + num_corners + num_centers);
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Call visit(diti) for each point of a uniform grid in a cell -- corners first, then centers.  See refine_grid(). */
+      template <class visit_t>
+      void for_each_grid_point(diti_t cell, int level_delta, visit_t&& visit) const {
+        diti_t tmp = ccc_cell_get_corner_min(cell);
+        if constexpr (dom_dim == 1) {
+          dic_t  del = ccc_cell_half_width(cell) >> level_delta;
+          for(int i=0; i<(1 << (1+level_delta))+1; i++) {
+            visit(tmp);
+            tmp += del;
+          }
+        } else if constexpr (dom_dim == 2) {
+          dic_t  del = static_cast<dic_t>(ccc_cell_full_width(cell) >> level_delta);
+          // Corners
+          for(dic_t i=0; i<(1 << level_delta)+1; i++) {
+            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
+            for(dic_t j=0; j<(1 << level_delta)+1; j++) {
+              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
+              visit(tmp3);
+            }
+          }
+          // Centers
+          tmp = cuc_inc_all_crd(tmp, del/2);
+          for(dic_t i=0; i<(1 << level_delta); i++) {
+            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
+            for(dic_t j=0; j<(1 << level_delta); j++) {
+              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
+              visit(tmp3);
+            }
+          }
+        } else if constexpr (dom_dim == 3) {
+          dic_t  del = static_cast<dic_t>(ccc_cell_full_width(cell) >> level_delta);
+          // Corners
+          for(dic_t i=0; i<(1 << level_delta)+1; i++) {
+            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
+            for(dic_t j=0; j<(1 << level_delta)+1; j++) {
+              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
+              for(dic_t k=0; k<(1 << level_delta)+1; k++) {
+                diti_t tmp4  = cuc_inc_crd(tmp3, 2, k*del);
+                visit(tmp4);
+              }
+            }
+          }
+          // Centers
+          tmp = cuc_inc_all_crd(tmp, del/2);
+          for(dic_t i=0; i<(1 << level_delta); i++) {
+            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
+            for(dic_t j=0; j<(1 << level_delta); j++) {
+              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
+              for(dic_t k=0; k<(1 << level_delta); k++) {
+                diti_t tmp4  = cuc_inc_crd(tmp3, 2, k*del);
+                visit(tmp4);
+              }
+            }
+          }
+        } else {
+          std::cout << "ERROR: refine_grid with dom_dim>3 not supported (use refine_recursive)!" << std::endl;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* True if refine_grid() should sample the given point -- always, unless the journal was resumed and the point already has a sample.  See
+         resume_from_journal(). */
+      inline bool grid_point_wanted(diti_t diti) const {
+        return ( !(journal.resumed && vertex_exists(diti)));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Evaluate a batch sample function on the given points, and store the results.  The function is called on blocks of at most sample_batch_size points. */
+      template <class batch_func_t>
+      void sample_points_batch(std::span<const diti_t> keys, batch_func_t& func) {
+        diti_list_t misses;
+        if (memo.file) {
+          misses = memo_filter(keys);
+          keys   = misses;
+        }
+        std::array<std::vector<src_t>, dom_dim> x_cols;
+        std::array<std::vector<src_t>, rng_dim> y_cols;
+        for(std::size_t start=0; start<keys.size(); start+=sample_batch_size) {
+          std::size_t num = std::min(sample_batch_size, keys.size()-start);
+          for(auto& c: x_cols)
+            c.resize(num);
+          for(auto& c: y_cols)
+            c.resize(num);
+          for(std::size_t k=0; k<num; k++) {
+            drpt_t x = diti_to_drpt(keys[start+k]);
+            for(int i=0; i<dom_dim; i++)
+              x_cols[i][k] = dom_at(x, i);
+          }
+          drpt_batch_t x_batch;
+          rrpt_batch_t y_batch;
+          for(int i=0; i<dom_dim; i++)
+            x_batch[i] = std::span<const src_t>(x_cols[i]);
+          for(int i=0; i<rng_dim; i++)
+            y_batch[i] = std::span<src_t>(y_cols[i]);
+          func(x_batch, y_batch);
+          for(std::size_t k=0; k<num; k++) {
+            rrpt_t y;
+            if constexpr (rng_dim == 1)
+              y = y_cols[0][k];
+            else
+              for(int i=0; i<rng_dim; i++)
+                y[i] = y_cols[i][k];
+            srpt_t val = rrpt_to_srpt(y);
+            memo_append(keys[start+k], val);
+            sample_put(keys[start+k], val);
+          }
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Call body(k) for k in [0, n) using up to thread_count threads.  Each thread handles one contiguous range of indexes.  With one thread, body is
+         called in index order on the calling thread. */
+      template <class body_t>
+      void parallel_for(std::size_t n, body_t&& body) const {
+        std::size_t num_threads = std::min(static_cast<std::size_t>(thread_count), 1 + n / parallel_min_thread_work);
+        if (num_threads <= 1) {
+          for(std::size_t k=0; k<n; k++)
+            body(k);
+        } else {
+          std::size_t chunk = (n + num_threads - 1) / num_threads;
+          std::vector<std::jthread> threads;
+          for(std::size_t t=0; t<num_threads; t++)
+            threads.emplace_back([&body, n, t, chunk]() {
+                                   for(std::size_t k=t*chunk; k<std::min(n, (t+1)*chunk); k++)
+                                     body(k);
+                                 });
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Evaluate a sample function on the given points using up to thread_count threads, and store the results.  Values are computed into a buffer, and
+         stored in key order after all threads finish -- so the sample store ends up exactly as it would with serial evaluation.  If serial is true, then
+         func is only called by the calling thread. */
+      template <class sample_func_t>
+      void sample_points_parallel(std::span<const diti_t> keys, sample_func_t& func, bool serial = false) {
+        if ((thread_count <= 1) || serial) {
+          for(auto k: keys)
+            sample_point(k, func);
+        } else {
+          std::vector<srpt_t> vals(keys.size());
+          std::vector<char>   hits(keys.size(), 0);
+          parallel_for(keys.size(), [this, &func, &keys, &vals, &hits](std::size_t k) {
+                                      if (memo.file && memo.file->lookup(keys[k], vals[k]))
+                                        hits[k] = 1;
+                                      else
+                                        vals[k] = rrpt_to_srpt(func(diti_to_drpt(keys[k])));
+                                    });
+          for(std::size_t k=0; k<keys.size(); k++) {
+            if (hits[k])
+              memo_hit_count++;
+            else
+              memo_append(keys[k], vals[k]);
+            sample_put(keys[k], vals[k]);
+          }
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Sample a point unless it has already been sampled.  With a concurrent store each point is sampled exactly once even when several threads race for
+         it -- late threads wait for the value.  The memo file (if one is open) is checked before func is called, but neither the memo file nor the hit
+         count is updated -- see refine_recursive_cell_pred_tasks().  Bricks are not used.
+         @return true if this call sampled the point */
+      template <class sample_func_t>
+      bool sample_point_once(diti_t diti, sample_func_t& func) {
+        if constexpr (store_is_concurrent)
+          return samples.try_emplace_with(diti, [this, &func, diti]() {
+                                                  srpt_t val;
+                                                  if (memo.file && memo.file->lookup(diti, val))
+                                                    return val;
+                                                  return rrpt_to_srpt(func(diti_to_drpt(diti)));
+                                                }).second;
+        else
+          return sample_point_maybe(diti, func);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* refine_once() using sample_point_once().  The cell must be able to have children.  If new_points is not nullptr, then points sampled by this call
+         are appended to it.
+         @return Number of points sampled by this call */
+      template <class sample_func_t>
+      std::size_t refine_once_concurrent(diti_t cell, sample_func_t& func, diti_list_t* new_points) {
+        std::size_t sample_count = 0;
+        for(auto const c : ccc_get_children_array(cell)) {
+          if (sample_point_once(c, func)) {
+            sample_count++;
+            if (new_points)
+              new_points->push_back(c);
+            for(auto const e: ccc_get_corners_array(c)) {
+              if (sample_point_once(e, func)) {
+                sample_count++;
+                if (new_points)
+                  new_points->push_back(e);
+              }
+            }
+          }
+        }
+        return sample_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* refine_recursive_cell_pred() using sample_point_once().  Several threads may run this on disjoint subtrees of one tree with a concurrent store.
+         @return Number of points sampled by this call */
+      template <class sample_func_t, class cell_pred_t>
+      std::size_t refine_recursive_cell_pred_concurrent(diti_t cell, int level, sample_func_t& func, cell_pred_t& pred, diti_list_t* new_points) {
+        std::size_t sample_count = 0;
+        if ((level < 0) || (ccc_cell_level(cell) < level)) {
+          if (cell_can_have_children(cell) && pred(cell)) {
+            sample_count += refine_once_concurrent(cell, func, new_points);
+            for(auto const c : ccc_get_children_array(cell))
+              sample_count += refine_recursive_cell_pred_concurrent(c, level, func, pred, new_points);
+          }
+        }
+        return sample_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Work stealing engine for the *_parallel() refiners.  Each seed cell is a task.  A task refines its cell (if pred is true), and then pushes each
+         child as a new task -- unless the child is within parallel_task_grain levels of the level limit, in which case the child subtree is refined in place
+         by refine_recursive_cell_pred_concurrent().  Each of thread_count threads (the calling thread is one of them) pops tasks from the back of its own queue,
+         and steals from the front of the other queues when its own is empty.  Stolen tasks are the oldest, and so usually the largest, subtrees.  Threads
+         finding no task at all sleep on a condition variable until a task is pushed or all tasks are done -- so threads refining large subtrees in place
+         do not compete for the queue locks with idle threads.  If a journal or memo file is open, then each thread records the points it samples, and the
+         calling thread journals them, and counts memo hits & adds the other points to the memo file, after all threads finish (neither file is thread safe).
+         @return Number of points sampled by each thread */
+      template <class sample_func_t, class cell_pred_t>
+      std::vector<std::size_t> refine_recursive_cell_pred_tasks(const diti_list_t& seeds, int level, sample_func_t& func, cell_pred_t& pred) {
+        struct task_queue_t {
+          std::mutex         mtx;
+          std::deque<diti_t> cells;
+        };
+        const int                 num_threads = thread_count;
+        const int                 task_level  = (((level < 0) || (level > max_level)) ? max_level : level) - parallel_task_grain;
+        std::vector<task_queue_t> queues(static_cast<std::size_t>(num_threads));
+        std::vector<std::size_t>  sample_counts(static_cast<std::size_t>(num_threads), 0);
+        std::vector<diti_list_t>  new_points(static_cast<std::size_t>(num_threads));  // Only filled if a journal or memo file is open
+        const bool                recording   = (journal.file || memo.file);
+        std::atomic<std::size_t>  num_pending = seeds.size();   // Tasks queued or running
+        std::atomic<std::size_t>  num_queued  = seeds.size();   // Tasks queued
+        std::atomic<int>          num_idle    = 0;              // Threads sleeping, or about to sleep, on idle_cv
+        std::mutex                idle_mtx;
+        std::condition_variable   idle_cv;
+        for(std::size_t i=0; i<seeds.size(); i++)
+          queues[i % queues.size()].cells.push_back(seeds[i]);
+        // Wake idle threads.  idle_mtx is taken so a thread between testing its wait predicate and sleeping can not miss the notification.
+        auto wake_idle = [&num_idle, &idle_mtx, &idle_cv](bool all) {
+          if (num_idle > 0) {
+            { std::lock_guard<std::mutex> lock(idle_mtx); }
+            if (all)
+              idle_cv.notify_all();
+            else
+              idle_cv.notify_one();
+          }
+        };
+        auto run_task = [this, level, task_level, recording, &func, &pred, &queues, &sample_counts, &new_points, &num_pending, &num_queued, &wake_idle](std::size_t t, diti_t cell) {
+          diti_list_t* thread_new_points = (recording ? &new_points[t] : nullptr);
+          if (((level < 0) || (ccc_cell_level(cell) < level)) && cell_can_have_children(cell) && pred(cell)) {
+            sample_counts[t] += refine_once_concurrent(cell, func, thread_new_points);
+            for(auto const c : ccc_get_children_array(cell)) {
+              if (ccc_cell_level(c) < task_level) {
+                num_pending++;
+                {
+                  std::lock_guard<std::mutex> lock(queues[t].mtx);
+                  num_queued++;  // Before the push, so a thief can not decrement it below the number of queued tasks
+                  queues[t].cells.push_back(c);
+                }
+                wake_idle(false);
+              } else {
+                sample_counts[t] += refine_recursive_cell_pred_concurrent(c, level, func, pred, thread_new_points);
+              }
+            }
+          }
+        };
+        auto worker = [&queues, &num_pending, &num_queued, &num_idle, &idle_mtx, &idle_cv, &wake_idle, &run_task](std::size_t t) {
+          while (num_pending > 0) {
+            diti_t cell  = 0;
+            bool   found = false;
+            for(std::size_t k=0; (k<queues.size()) && !found; k++) {
+              task_queue_t& q = queues[(t+k) % queues.size()];
+              std::lock_guard<std::mutex> lock(q.mtx);
+              if ( !(q.cells.empty())) {
+                found = true;
+                num_queued--;
+                if (k == 0) {
+                  cell = q.cells.back();
+                  q.cells.pop_back();
+                } else {
+                  cell = q.cells.front();
+                  q.cells.pop_front();
+                }
+              }
+            }
+            if (found) {
+              run_task(t, cell);
+              if (--num_pending == 0)
+                wake_idle(true);
+            } else {
+              std::unique_lock<std::mutex> lock(idle_mtx);
+              num_idle++;
+              idle_cv.wait(lock, [&num_pending, &num_queued]() { return ((num_pending == 0) || (num_queued > 0)); });
+              num_idle--;
+            }
+          }
+        };
+        {
+          std::vector<std::jthread> threads;
+          for(std::size_t t=1; t<queues.size(); t++)
+            threads.emplace_back(worker, t);
+          worker(0);
+        }
+        for(auto const& thread_points : new_points) {
+          for(auto diti : thread_points) {
+            srpt_t val = sample_get(diti);
+            if (memo.file) {
+              srpt_t memo_val;
+              if ( !(memo_lookup(diti, memo_val)))
+                memo_append(diti, val);
+            }
+            if (journal.file)
+              journal.file->append(diti, val);
+          }
+        }
+        return sample_counts;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Leaf cells of the given cell with a level less than level and for which pred is true.  The predicate is evaluated using up to thread_count threads,
+         and the cells are returned in get_leaf_cells() order. */
+      template <class cell_pred_t>
+      diti_list_t leaves_to_refine(diti_t cell, int level, cell_pred_t& pred) const {
+        diti_list_t leaves = get_leaf_cells(cell);
+        if (level >= 0)
+          std::erase_if(leaves, [this, level](diti_t c) { return (ccc_cell_level(c) >= level); });
+        std::vector<char> keep(leaves.size());
+        parallel_for(leaves.size(), [&pred, &leaves, &keep](std::size_t k) { keep[k] = (pred(leaves[k]) ? 1 : 0); });
+        diti_list_t cells_to_refine;
+        for(std::size_t k=0; k<leaves.size(); k++)
+          if (keep[k])
+            cells_to_refine.push_back(leaves[k]);
+        return cells_to_refine;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Refine the given cells in three steps: plan, evaluate, & commit.  First all new vertexes are collected in the order refine_once() would sample them,
+         and duplicates shared by neighboring cells are removed (keeping the first).  Then the function is evaluated on the new points using up to
+         thread_count threads (one if serial is true).  Finally the samples are stored in plan order.  The result is identical to calling refine_once() on
+         each cell in turn.
+         @return Number of cells refined. */
+      template <class sample_func_t>
+      int refine_cells_parallel(const diti_list_t& cells, sample_func_t& func, bool serial = false) {
+        // Plan: children centers followed by their corners -- just like sample_cell()
+        diti_list_t new_points;
+        int refined_count = 0;
+        for(auto c: cells) {
+          if (cell_can_have_children(c)) {
+            refined_count++;
+            for(auto const child : ccc_get_children_array(c)) {
+              if ( !(vertex_exists(child))) {
+                new_points.push_back(child);
+                for(auto const v : ccc_get_corners_array(child))
+                  if ( !(vertex_exists(v)))
+                    new_points.push_back(v);
+              }
+            }
+          }
+        }
+        // Remove duplicates keeping first occurrence
+        std::vector<std::size_t> order(new_points.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&new_points](std::size_t a, std::size_t b) { return new_points[a] < new_points[b]; });
+        std::vector<char> dup(new_points.size(), 0);
+        for(std::size_t k=1; k<order.size(); k++)
+          if (new_points[order[k]] == new_points[order[k-1]])
+            dup[order[k]] = 1;
+        std::size_t num_unique = 0;
+        for(std::size_t k=0; k<new_points.size(); k++)
+          if ( !(dup[k]))
+            new_points[num_unique++] = new_points[k];
+        new_points.resize(num_unique);
+        // Evaluate & commit
+        sample_points_parallel(new_points, func, serial);
+        return refined_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* The leaf holding the region across the given face of cell if that leaf is coarser than cell (or is a leaf at the level of cell), and 0 otherwise.
+         Found by walking up from the neighbor at the level of cell to its deepest existing ancestor. */
+      diti_t ccc_get_coarse_neighbor_leaf(diti_t cell, int index, int direction) const {
+        diti_t nbr = ccc_get_neighbor(cell, index, direction);
+        if (nbr == 0)
+          return 0;
+        for(int level=static_cast<int>(ccc_cell_level(cell)); level>=0; level--) {
+          diti_t anc = static_cast<diti_t>((nbr & level_cell_masks[level]) + diti_all_units * (static_cast<diti_t>(1) << (max_level-1-level)));
+          if (vertex_exists(anc))
+            return ((cell_has_child(anc)) ? 0 : anc);
+        }
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Unbalanced (at level_delta) leaves after refining the given cells: children still unbalanced against deeper neighbors, and face neighbor leaves
+         more than level_delta levels coarser than the children.  Cells without children are ignored.  The result is sorted, and has no duplicates. */
+      diti_list_t leaves_unbalanced_by(std::span<const diti_t> cells, int level_delta) const {
+        diti_list_t rv;
+        for(auto c: cells) {
+          if (cell_has_child(c)) {
+            for(auto const child : ccc_get_children_array(c))
+              if (cell_is_unbalanced(level_delta, child))
+                rv.push_back(child);
+            int child_level = static_cast<int>(ccc_cell_level(c)) + 1;
+            for(int aix=0; aix<dom_dim; aix++) {
+              for(int dir=-1; dir<2; dir+=2) {
+                diti_t leaf = ccc_get_coarse_neighbor_leaf(c, aix, dir);
+                if ((leaf != 0) && (child_level > static_cast<int>(ccc_cell_level(leaf)) + level_delta))
+                  rv.push_back(leaf);
+              }
+            }
+          }
+        }
+        std::sort(rv.begin(), rv.end());
+        rv.erase(std::unique(rv.begin(), rv.end()), rv.end());
+        return rv;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Refine the given cells with refine_cells_parallel().  Then, if level_delta is non-negative, ripple: refine the leaves made unbalanced by the new
+         cells, then the leaves made unbalanced by those, and so on.  Only face neighbors of newly refined cells are examined, so the work depends on the
+         number of cells refined -- not on the size of the tree.  If serial is true, then func is only called by the calling thread.
+         @return Number of the given cells refined (cells refined by the ripple are not counted). */
+      template <class sample_func_t>
+      int refine_cells_rippled(const diti_list_t& cells, int level_delta, sample_func_t& func, bool serial = false) {
+        int refined_count = refine_cells_parallel(cells, func, serial);
+        if (level_delta >= 0) {
+          diti_list_t ripple = leaves_unbalanced_by(cells, level_delta);
+          while ( !(ripple.empty())) {
+            refine_cells_parallel(ripple, func, serial);
+            ripple = leaves_unbalanced_by(ripple, level_delta);
+          }
+        }
+        return refined_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Evaluate an async sample function on the given points, and store the results.  At most async_window evaluations are in flight at once.  Results
+         are stored in key order -- when the window is full, we wait for the oldest evaluation. */
+      template <class async_func_t>
+      void sample_points_async(std::span<const diti_t> keys, async_func_t& func) {
+        diti_list_t misses;
+        if (memo.file) {
+          misses = memo_filter(keys);
+          keys   = misses;
+        }
+        std::deque<std::invoke_result_t<async_func_t&, drpt_t>> in_flight;
+        std::size_t next_commit = 0;
+        auto commit_oldest = [this, &keys, &in_flight, &next_commit]() {
+          srpt_t val = rrpt_to_srpt(static_cast<rrpt_t>(in_flight.front().get()));
+          memo_append(keys[next_commit], val);
+          sample_put(keys[next_commit++], val);
+          in_flight.pop_front();
+        };
+        for(std::size_t k=0; k<keys.size(); k++) {
+          if (in_flight.size() >= async_window)
+            commit_oldest();
+          in_flight.push_back(func(diti_to_drpt(keys[k])));
+        }
+        while ( !(in_flight.empty()))
+          commit_oldest();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Point samplers for refine_cells_planned() & refine_recursive_cell_pred_planned(). */
+      template <class batch_func_t>
+      auto batch_sampler(batch_func_t& func) { return [this, &func](std::span<const diti_t> keys) { sample_points_batch(keys, func); }; }
+      template <class async_func_t>
+      auto async_sampler(async_func_t& func) { return [this, &func](std::span<const diti_t> keys) { sample_points_async(keys, func); }; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Refine the given cells.  All new vertexes of all children are collected, sorted, & made unique.  They are then sampled with one call to
+         sample_points (see batch_sampler() & async_sampler()).
+         @return Number of cells refined. */
+      template <class sampler_t>
+      int refine_cells_planned(const diti_list_t& cells, sampler_t&& sample_points) {
+        diti_list_t new_points;
+        int refined_count = 0;
+        for(auto c: cells) {
+          if (cell_can_have_children(c)) {
+            refined_count++;
+            for(auto const child : ccc_get_children_array(c))
+              for(auto const v : ccc_get_vertexes_array(child))
+                if ( !(vertex_exists(v)))
+                  new_points.push_back(v);
+          }
+        }
+        std::sort(new_points.begin(), new_points.end());
+        new_points.erase(std::unique(new_points.begin(), new_points.end()), new_points.end());
+        sample_points(new_points);
+        return refined_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Refine breadth first, starting with the given cells, every cell for which pred is true & the level is less than the given level.  Each generation
+         of cells is refined with one refine_cells_planned() call. */
+      template <class sampler_t, class cell_pred_t>
+      void refine_recursive_cell_pred_planned(diti_list_t cells, int level, sampler_t&& sample_points, cell_pred_t& pred) {
+        diti_list_t cells_to_refine;
+        while ( !(cells.empty())) {
+          cells_to_refine.clear();
+          for(auto c: cells)
+            if (((level < 0) || (ccc_cell_level(c) < level)) && cell_can_have_children(c) && pred(c))
+              cells_to_refine.push_back(c);
+          refine_cells_planned(cells_to_refine, sample_points);
+          cells.clear();
+          for(auto c: cells_to_refine)
+            for(auto const child : ccc_get_children_array(c))
+              cells.push_back(child);
+        }
+      }
       //@}
 
     public:
@@ -308,6 +1553,22 @@ namespace mjr {
           @param new_bbox_min Value to use for bounding box minimum point
           @param new_bbox_max Value to use for bounding box maximum point */
       MR_rect_tree(drpt_t new_bbox_min, drpt_t new_bbox_max)                    { set_bbox(new_bbox_min, new_bbox_max);   }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Set real coordinate as specified, and adopt an existing sample store.
+          @param new_bbox_min Value to use for bounding box minimum point
+          @param new_bbox_max Value to use for bounding box maximum point
+          @param new_samples  Sample store to move into the new tree */
+      MR_rect_tree(drpt_t new_bbox_min, drpt_t new_bbox_max, sample_store_t&& new_samples) : samples(std::move(new_samples)) {
+        set_bbox(new_bbox_min, new_bbox_max);
+        leaf_index_invalidate();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Copy a tree.  The copy does not use the memo file or the journal of the original (they are not thread safe), so open them again in the copy if
+          required.  Likewise assigning to a tree closes its memo file & journal.  See open_memo_file() & open_journal(). */
+      MR_rect_tree(const MR_rect_tree&)            = default;
+      MR_rect_tree(MR_rect_tree&&)                 = default;
+      MR_rect_tree& operator=(const MR_rect_tree&) = default;
+      MR_rect_tree& operator=(MR_rect_tree&&)      = default;
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -315,7 +1576,9 @@ namespace mjr {
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Update the value of bbox_delta.
-          Use this after modifying the value of bbox_min or bbox_max. */
+          Use this after modifying the value of bbox_min or bbox_max.  If a memo file is open, then it is reopened for the new bounding box.  If a journal is
+          open, then it is detached: the file is left as written (its records belong to the old bounding box), and new samples are not journaled until
+          open_journal() is called.  A resumed journal still makes refine_grid() skip existing points.  See resume_from_journal(). */
       void update_bbox_delta() {
         if constexpr (dom_dim == 1) {
           bbox_delta = (bbox_max - bbox_min) / ((dic_t(1) << max_level));
@@ -332,6 +1595,9 @@ namespace mjr {
             }
           }
         }
+        if (memo.file)
+          open_memo_file(memo.file->get_file_name(), memo_tag);
+        journal.file.reset();  // journal.resumed is kept
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Set the bounding box
@@ -379,7 +1645,22 @@ namespace mjr {
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return the sample value for vertex.
           @param vertex Input vertex */
-      inline rrpt_t get_sample(diti_t vertex) const { return samples.at(vertex); }
+      inline rrpt_t get_sample(diti_t vertex) const { return srpt_to_rrpt(sample_get(vertex)); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Return one component of the sample value for vertex.
+          With a column store (MR_soa_map) only the requested component is read.
+          @param vertex      Input vertex
+          @param range_index Index of the range component */
+      inline src_t get_sample_component(diti_t vertex, int range_index) const {
+        if constexpr (requires { samples.component_at(vertex, range_index); }) {
+          std::size_t slot = brick_slot(vertex);
+          if (slot != brick_npos)
+            return rng_at(srpt_to_rrpt(brick_vals[slot]), range_index);
+          return static_cast<src_t>(samples.component_at(vertex, range_index));
+        } else {
+          return rng_at(get_sample(vertex), range_index);
+        }
+      }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return the sample value for vertex as an rrta_t (an std::array)
           @param vertex Input vertex */
@@ -394,11 +1675,103 @@ namespace mjr {
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Provide a constant forward iterator for the sample data.
           Sample data is stored as a pair with the first element being the packed integer domain coordinates and the second being the sampled data. */
-      inline  std::unordered_map<diti_t, rrpt_t>::const_iterator cbegin_samples()  { return samples.cbegin(); }
+      inline sample_citr_t cbegin_samples() const { return sample_citr_t(this, samples.cbegin(), 0); }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Provide a constant end iterator for the sample data.
           see: cbegin_samples(). */
-      inline  std::unordered_map<diti_t, rrpt_t>::const_iterator   cend_samples()  { return samples.cend();   }
+      inline sample_citr_t   cend_samples() const { return sample_citr_t(this, samples.cend(), brick_vals.size()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Return the number of samples in the tree. */
+      inline std::size_t get_sample_count() const { return samples.size() + brick_sample_count; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Minimum value of one range component over all samples.  NaN values are ignored.
+          With a column store (MR_soa_map) this is a scan over a single contiguous array.
+          @param range_index Index of the range component
+          @return The minimum, or infinity if there are no non-NaN values. */
+      src_t get_sample_component_min(int range_index) const {
+        src_t ret = std::numeric_limits<src_t>::infinity();
+        if constexpr (requires { samples.column(range_index); }) {
+          for(auto v: samples.column(range_index))
+            ret = std::min(ret, static_cast<src_t>(v));
+        } else {
+          for(const auto& kvp : samples)
+            ret = std::min(ret, rng_at(srpt_to_rrpt(kvp.second), range_index));
+        }
+        for_each_brick_sample([this, &ret, range_index](diti_t, const srpt_t& v) { ret = std::min(ret, rng_at(srpt_to_rrpt(v), range_index)); });
+        return ret;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Maximum value of one range component over all samples.  NaN values are ignored.
+          With a column store (MR_soa_map) this is a scan over a single contiguous array.
+          @param range_index Index of the range component
+          @return The maximum, or negative infinity if there are no non-NaN values. */
+      src_t get_sample_component_max(int range_index) const {
+        src_t ret = -std::numeric_limits<src_t>::infinity();
+        if constexpr (requires { samples.column(range_index); }) {
+          for(auto v: samples.column(range_index))
+            ret = std::max(ret, static_cast<src_t>(v));
+        } else {
+          for(const auto& kvp : samples)
+            ret = std::max(ret, rng_at(srpt_to_rrpt(kvp.second), range_index));
+        }
+        for_each_brick_sample([this, &ret, range_index](diti_t, const srpt_t& v) { ret = std::max(ret, rng_at(srpt_to_rrpt(v), range_index)); });
+        return ret;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Count samples with a NaN in the given range component.
+          With a column store (MR_soa_map) this is a scan over a single contiguous array.
+          @param range_index Index of the range component */
+      std::size_t count_nan_sample_components(int range_index) const {
+        std::size_t ret = 0;
+        if constexpr (requires { samples.column(range_index); }) {
+          for(auto v: samples.column(range_index))
+            ret += (std::isnan(v) ? 1 : 0);
+        } else {
+          for(const auto& kvp : samples)
+            ret += (std::isnan(rng_at(srpt_to_rrpt(kvp.second), range_index)) ? 1 : 0);
+        }
+        for_each_brick_sample([this, &ret, range_index](diti_t, const srpt_t& v) { ret += (std::isnan(rng_at(srpt_to_rrpt(v), range_index)) ? 1 : 0); });
+        return ret;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Count samples with a NaN in any range component (i.e. samples for which vertex_is_nan() is true).
+          With a column store (MR_soa_map) each column is scanned in turn. */
+      std::size_t count_nan_samples() const {
+        std::size_t ret = 0;
+        for_each_brick_sample([this, &ret](diti_t, const srpt_t& v) { ret += (rrpt_is_nan(srpt_to_rrpt(v)) ? 1 : 0); });
+        if constexpr (requires { samples.column(0); }) {
+          std::vector<uint8_t> row_is_nan(samples.size(), 0);
+          for(int i=0; i<rng_dim; i++) {
+            auto col = samples.column(i);
+            for(std::size_t j=0; j<col.size(); j++)
+              if (std::isnan(col[j]))
+                row_is_nan[j] = 1;
+          }
+          return ret + static_cast<std::size_t>(std::count(row_is_nan.cbegin(), row_is_nan.cend(), 1));
+        } else {
+          for(const auto& kvp : samples)
+            ret += (rrpt_is_nan(srpt_to_rrpt(kvp.second)) ? 1 : 0);
+          return ret;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Reserve space in the sample store for a total of count samples.
+          Useful before large sampling operations (refine_grid() reserves automatically).
+          @param count The number of samples */
+      inline void reserve_samples(std::size_t count) { samples.reserve(count); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Create a read only copy of the tree optimized for queries.
+
+          The returned tree (a ::frozen_t) has the same bounding box and samples, but stores them in an MR_sorted_map -- sorted keys with values packed
+          alongside.  It supports the entire const query API (vertex_exists(), get_sample(), cell_has_child(), get_leaf_cells(), get_existing_neighbor(),
+          the cell predicates, etc...), and may be passed to anything templated on the tree type (like MR_rt_to_cc).  Methods that add samples will not
+          compile for a frozen tree.
+
+          Frozen trees use less memory than hash stores (no empty slots), and searches touch few cache lines.  Use freeze() when refinement is finished
+          and the tree will be queried heavily. */
+      frozen_t freeze() const {
+        return frozen_t(bbox_min, bbox_max, typename frozen_t::sample_store_t(cbegin_samples(), cend_samples()));
+      }
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -464,6 +1837,10 @@ namespace mjr {
           @param cell Input cell */
       diti_list_t ccc_get_corners(diti_t cell) const { return cuc_two_cross(cell, ccc_cell_half_width(cell)); }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_corners().
+          @param cell Input cell */
+      inline diti_corners_t ccc_get_corners_array(diti_t cell) const { return cuc_two_cross_array(cell, ccc_cell_half_width(cell)); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return a list of the corners of the given cell
           @warning No error checking -- cell must be a valid center coordinate. See: cell_good_cords()
           @param cell Input cell
@@ -471,12 +1848,26 @@ namespace mjr {
           @param direction The direction on the given index.  Must be 1 or -1.  No error checking. */
       diti_list_t ccc_get_corners(diti_t cell, int index, int direction) const { return cuc_two_cross(cell, ccc_cell_half_width(cell), index, direction); }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_corners().
+          @param cell Input cell
+          @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
+          @param direction The direction on the given index.  Must be 1 or -1.  No error checking. */
+      inline diti_face_corners_t ccc_get_corners_array(diti_t cell, int index, int direction) const {
+        return cuc_two_cross_array(cell, ccc_cell_half_width(cell), index, direction);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return a list of potential neighbor cells of the specified cell
           Note the cells are not in canonical order!
           @warning No error checking -- cell must be a valid center coordinate. See: cell_good_cords()
           @param cell Input cell */
       diti_list_t ccc_get_neighbors(diti_t cell) const { return cuc_axis_cross(cell, ccc_cell_full_width(cell)); }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_neighbors().
+          @param cell Input cell
+          @param nbrs The first elements are filled with the potential neighbors
+          @return Number of potential neighbors placed in nbrs */
+      inline int ccc_get_neighbors_array(diti_t cell, diti_axis_t& nbrs) const { return cuc_axis_cross_array(cell, ccc_cell_full_width(cell), nbrs); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return the potential neighbor cell along the given axis in the specified direction.
           @warning No error checking -- cell must be a valid center coordinate. See: cell_good_cords()
           @param cell      Input cell
@@ -509,6 +1900,11 @@ namespace mjr {
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_children().
+          @warning Unlike ccc_get_children(), the result is garbage if the cell is at max_level.  See: cell_can_have_children()
+          @param cell Input cell */
+      inline diti_corners_t ccc_get_children_array(diti_t cell) const { return cuc_two_cross_array(cell, ccc_cell_quarter_width(cell)); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return a list of child cells of the specified cell
           An empty vector is returned if no children are possible.
           @warning This isn't a check for existing, sampled children -- it simply returns the coordinates of potential children.
@@ -524,11 +1920,30 @@ namespace mjr {
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_children().
+          @warning Unlike ccc_get_children(), the result is garbage if the cell is at max_level.  See: cell_can_have_children()
+          @param cell Input cell
+          @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
+          @param direction The direction on the given index.  Must be 1 or -1.  No error checking. */
+      inline diti_face_corners_t ccc_get_children_array(diti_t cell, int index, int direction) const {
+        return cuc_two_cross_array(cell, ccc_cell_quarter_width(cell), index, direction);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return a list of the vertexes (corners and center) of the given cell
           @param cell Input cell */
-      diti_list_t ccc_get_vertexes(diti_t cell) const {
-        diti_list_t rv = ccc_get_corners(cell);
-        rv.push_back(cell);
+      diti_list_t ccc_get_vertexes(diti_t cell) const {
+        diti_list_t rv = ccc_get_corners(cell);
+        rv.push_back(cell);
+        return rv;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of ccc_get_vertexes().
+          @param cell Input cell */
+      inline diti_vertexes_t ccc_get_vertexes_array(diti_t cell) const {
+        diti_vertexes_t rv;
+        diti_corners_t corners = ccc_get_corners_array(cell);
+        std::copy(corners.cbegin(), corners.cend(), rv.begin());
+        rv.back() = cell;
         return rv;
       }
       //@}
@@ -621,19 +2036,21 @@ namespace mjr {
           @param delta The Distance for the cross product points
           @return Last of cross product points */
       diti_list_t cuc_two_cross(diti_t diti, dic_t delta) const {
+        diti_corners_t rv = cuc_two_cross_array(diti, delta);
+        return diti_list_t(rv.cbegin(), rv.cend());
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of cuc_two_cross().
+          @param diti Center coordinates for the cross product points
+          @param delta The Distance for the cross product points
+          @return Array of cross product points */
+      inline diti_corners_t cuc_two_cross_array(diti_t diti, dic_t delta) const {
         //  MJR TODO NOTE <2024-07-11T11:50:36-0500> cuc_two_cross: If diti is close to an corner, some result points may be out of range.
-        diti_list_t rv;
-        for(int i=0; i<(1 << dom_dim); i++) {
-          diti_t tmp = diti;
-          for(int j=0; j<dom_dim; j++) {
-            if (i & (1 << j)) {
-              tmp = cuc_inc_crd(tmp, j, delta);
-            } else {
-              tmp = cuc_dec_crd(tmp, j, delta);
-            }
-          }
-          rv.push_back(tmp);
-        }
+        const diti_t base  = static_cast<diti_t>(diti - static_cast<diti_t>(delta) * diti_all_units);
+        const diti_t delta2 = static_cast<diti_t>(2 * static_cast<diti_t>(delta));
+        diti_corners_t rv;
+        for(int i=0; i<(1 << dom_dim); i++)
+          rv[i] = static_cast<diti_t>(base + delta2 * two_cross_patterns[i]);
         return rv;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -652,22 +2069,23 @@ namespace mjr {
           @param direction The direction on the given index.  Must be 1 or -1.  No error checking.
           @return List of cross product points */
       diti_list_t cuc_two_cross(diti_t diti, dic_t delta, int index, int direction) const {
-        diti_list_t rv;
-        if (direction != 1)
-          direction = 0;
-        for(int i=0; i<(1 << dom_dim); i++) {
-          if (((i >> index) & 1) == direction) {
-            diti_t tmp = diti;
-            for(int j=0; j<dom_dim; j++) {
-              if ((i >> j) & 1) {
-                tmp = cuc_inc_crd(tmp, j, delta);
-              } else {
-                tmp = cuc_dec_crd(tmp, j, delta);
-              }
-            }
-            rv.push_back(tmp);
-          }
-        }
+        diti_face_corners_t rv = cuc_two_cross_array(diti, delta, index, direction);
+        return diti_list_t(rv.cbegin(), rv.cend());
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of cuc_two_cross().
+          @param diti Center coordinates for the cross product points
+          @param delta     The Distance for the cross product points.
+          @param index     The index to hold constant.  Must be in [0, dom_dom-1].  No error checking.
+          @param direction The direction on the given index.  Must be 1 or -1.  No error checking.
+          @return Array of cross product points */
+      inline diti_face_corners_t cuc_two_cross_array(diti_t diti, dic_t delta, int index, int direction) const {
+        const diti_t base   = static_cast<diti_t>(diti - static_cast<diti_t>(delta) * diti_all_units);
+        const diti_t delta2 = static_cast<diti_t>(2 * static_cast<diti_t>(delta));
+        const auto&  pats   = face_cross_patterns[index][(direction == 1 ? 1 : 0)];
+        diti_face_corners_t rv;
+        for(int i=0; i<(1 << (dom_dim-1)); i++)
+          rv[i] = static_cast<diti_t>(base + delta2 * pats[i]);
         return rv;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -683,20 +2101,27 @@ namespace mjr {
           @param delta The Distance for the cross points
           @return Last of cross product points */
       diti_list_t cuc_axis_cross(diti_t diti, dic_t delta) const {
-        diti_list_t rv;
+        diti_axis_t rv;
+        int n = cuc_axis_cross_array(diti, delta, rv);
+        return diti_list_t(rv.cbegin(), rv.cbegin()+n);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Allocation free version of cuc_axis_cross().
+          @param diti Center coordinates for the cross
+          @param delta The Distance for the cross points
+          @param rv The first elements are filled with the cross points
+          @return Number of cross points placed in rv */
+      inline int cuc_axis_cross_array(diti_t diti, dic_t delta, diti_axis_t& rv) const {
+        int n = 0;
         for(int idx=0; idx<dom_dim; idx++) {
-          for(int up=0; up<2; up++) {
-            dic_t tmp = cuc_get_crd(diti, idx);
-            if (up) {
-              if ((dic_max-tmp) >= delta)
-                rv.push_back(cuc_inc_crd(diti, idx, delta));
-            } else {
-              if (tmp >= delta)
-                rv.push_back(cuc_dec_crd(diti, idx, delta));
-            }
-          }
+          const dic_t  tmp = cuc_get_crd(diti, idx);
+          const diti_t off = static_cast<diti_t>(static_cast<diti_t>(delta) * two_cross_patterns[1 << idx]);
+          if (tmp >= delta)
+            rv[n++] = static_cast<diti_t>(diti - off);
+          if ((dic_max-tmp) >= delta)
+            rv[n++] = static_cast<diti_t>(diti + off);
         }
-        return rv;
+        return n;
       }
       //@}
 
@@ -736,7 +2161,7 @@ namespace mjr {
         } else {
           diti_t rv = 0;
           for(int i=0; i<dom_dim; i++)
-            rv |= (dita[i] << (i * dic_bits));
+            rv |= static_cast<diti_t>(static_cast<diti_t>(dita[i]) << (i * dic_bits));
           return rv;
         }
       }
@@ -796,6 +2221,121 @@ namespace mjr {
       }
       //@}
 
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Sample Memo File
+
+          A memo file remembers sample function results on disk (see MR_memo_file).  While one is open, the sampling & refinement members look each point up
+          in the memo file before calling the sample function, and add new results to it.  Rerunning a refinement script with small changes then only costs
+          the new samples.  One file may be shared by many trees and processes -- results are kept apart by a context computed from a tag naming the sample
+          function, the bounding box, max_level, and the dimensions.
+
+          Copies of a tree do not use the memo file of the original -- open the file again in the copy if required. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Open a memo file, creating it if required.
+          @warning Results are only reused when the tag matches, so use a different tag for each different sample function.
+          @param file_name Name of the memo file
+          @param func_tag  Name for the sample function
+          @return 0 on success, and 1 on error (no memo file is used) */
+      int open_memo_file(std::string file_name, std::string func_tag) {
+        memo_tag = func_tag;
+        auto new_memo = std::make_unique<memo_file_t>();
+        if (new_memo->open(file_name, file_context(memo_tag))) {
+          memo.file.reset();
+          return 1;
+        }
+        memo.file = std::move(new_memo);
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Stop using the memo file, and write new results to it. */
+      void close_memo_file() { memo.file.reset(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Write new results to the memo file now. */
+      void flush_memo_file() {
+        if (memo.file)
+          memo.file->flush();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if a memo file is in use */
+      bool memo_file_is_open() const { return static_cast<bool>(memo.file); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of samples taken from the memo file instead of calling the sample function */
+      std::size_t get_memo_hit_count() const { return memo_hit_count; }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Journal
+
+          A journal is a write ahead log of samples (see MR_journal_file).  While one is open, every sample stored by the sampling & refinement members is
+          appended to it.  If a long refinement run dies, resume_from_journal() puts the journaled samples back into a new tree.  The leaf & recursive
+          refinement members skip points that already have samples, so rerunning the same refinement only evaluates the points that were lost.  After
+          resume_from_journal() refine_grid() skips existing points too.  Records are collected in batches, and written by a background thread, so
+          journaling adds little to the sampling loop.
+
+          The *_parallel() refiners (concurrent sample stores) journal the samples they take after all of their threads finish -- so a run that dies in the
+          middle of one of them loses the samples taken by that call.  Copies of a tree do not write to the journal of the original, load() closes the
+          journal, and changing the bounding box detaches it (see update_bbox_delta()).
+
+          Example:
+          @code
+          tt_t tree(bbox_min, bbox_max);
+          if (std::filesystem::exists("run.jrnl"))
+            tree.resume_from_journal("run.jrnl");
+          else
+            tree.open_journal("run.jrnl");
+          tree.refine_grid(5, f);
+          tree.refine_leaves_recursive_cell_pred(10, f, pred);
+          @endcode */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Start a new journal.  The file is created (or truncated), and every sample currently in the tree is written to it.  Any open journal is closed.
+          @param file_name Name of the journal file
+          @return 0 on success, and 1 on error (no journal is used) */
+      int open_journal(std::string file_name) {
+        close_journal();
+        auto new_journal = std::make_unique<journal_file_t>();
+        if (new_journal->create(file_name, file_context("")))
+          return 1;
+        for(auto itr=cbegin_samples(); itr!=cend_samples(); ++itr)
+          new_journal->append(itr->first, itr->second);
+        journal.file = std::move(new_journal);
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Store every sample in an existing journal, and then continue journaling new samples to it.  Any open journal is closed.  Until close_journal() or
+          open_journal() is called, refine_grid() only samples points without samples.
+          @warning The tree must have the same bounding box as the tree that wrote the journal.
+          @param file_name Name of the journal file
+          @return 0 on success, and 1 on error (no journal is used) */
+      int resume_from_journal(std::string file_name) {
+        close_journal();
+        auto new_journal = std::make_unique<journal_file_t>();
+        if (new_journal->resume(file_name, file_context(""), [this](diti_t diti, const srpt_t& val) { sample_put(diti, val); }))
+          return 1;
+        journal.file    = std::move(new_journal);
+        journal.resumed = true;
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Wait until every journaled sample has been written to the file.
+          @return 0 on success, and 1 on error (including when no journal is open) */
+      int flush_journal() {
+        if ( !(journal.file))
+          return 1;
+        return journal.file->flush();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Write every journaled sample, and stop journaling.  The file is kept. */
+      void close_journal() {
+        journal.file.reset();
+        journal.resumed = false;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if a journal is in use */
+      bool journal_is_open() const { return static_cast<bool>(journal.file); }
+      //@}
+
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
       /** @name Function Sampleing
 
@@ -804,16 +2344,20 @@ namespace mjr {
       /** Sample a cell.
           @param cell Cell to sample
           @param func Function to use for samples */
-      void sample_cell(diti_t cell, drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void sample_cell(diti_t cell, sample_func_t&& func) {
         if (sample_point_maybe(cell, func)) {
-          for(auto const e: ccc_get_corners(cell)) {
+          for(auto const e: ccc_get_corners_array(cell)) {
             sample_point_maybe(e, func);
           }
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      void sample_cell(drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void sample_cell(sample_func_t&& func) {
         sample_cell(ccc_get_top_cell(), func);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -821,11 +2365,11 @@ namespace mjr {
           @param diti Point at which to sample
           @param func Function to sample
           @return true if we sampled the point, and false otherwise. */
-      inline bool sample_point_maybe(diti_t diti, drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      inline bool sample_point_maybe(diti_t diti, sample_func_t&& func) {
         if ( !(vertex_exists(diti))) {
-          drpt_t xvec = diti_to_drpt(diti);
-          rrpt_t val = func(xvec);
-          samples[diti] = val;
+          sample_point(diti, func);
           return true;
         } else {
           return false;
@@ -833,19 +2377,133 @@ namespace mjr {
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Sample, or resample, a point.
+          If a memo file is open (see open_memo_file()), and it holds the point, then the value is taken from the memo file and func is not called.
           @param diti Point at which to sample
           @param func Function to sample */
-      inline void sample_point(diti_t diti, drpt2rrpt_func_t func) {
-        drpt_t xvec = diti_to_drpt(diti);
-        rrpt_t val = func(xvec);
-        samples[diti] = val;
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      inline void sample_point(diti_t diti, sample_func_t&& func) {
+        srpt_t val;
+        if ( !(memo_lookup(diti, val))) {
+          drpt_t xvec = diti_to_drpt(diti);
+          val = rrpt_to_srpt(func(xvec));
+          memo_append(diti, val);
+        }
+        sample_put(diti, val);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Wrap a scalar sample function so that it may be used where a batch sample function is required.
+          @param func Function to wrap.  Must be invocable with a ::drpt_t, and return a ::rrpt_t.
+          @return A batch sample function calling func once for each point. */
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      static auto make_batch_func(sample_func_t func) {
+        return [func](const drpt_batch_t& x_batch, const rrpt_batch_t& y_batch) mutable {
+          for(std::size_t k=0; k<x_batch[0].size(); k++) {
+            drpt_t x;
+            if constexpr (dom_dim == 1)
+              x = x_batch[0][k];
+            else
+              for(int i=0; i<dom_dim; i++)
+                x[i] = x_batch[i][k];
+            rrpt_t y = func(x);
+            if constexpr (rng_dim == 1)
+              y_batch[0][k] = y;
+            else
+              for(int i=0; i<rng_dim; i++)
+                y_batch[i][k] = y[i];
+          }
+        };
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Set the maximum number of points passed to a batch sample function in one call.
+          @param new_batch_size New maximum.  Values less than 1 are treated as 1. */
+      void set_sample_batch_size(std::size_t new_batch_size) { sample_batch_size = std::max(static_cast<std::size_t>(1), new_batch_size); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Get the maximum number of points passed to a batch sample function in one call. */
+      std::size_t get_sample_batch_size() const { return sample_batch_size; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Set the number of threads used to evaluate sample functions, cell predicates, & interpolations.
+          When the thread count is greater than one, the following members use several threads:
+            - refine_grid(): the sample function
+            - refine_leaves_once_if_cell_pred() & refine_leaves_atomically_if_cell_pred(): the predicate, and the sample function (also the ripple when
+              set_balance_delta() is on)
+            - The batch & async forms of those two: the predicate
+            - balance_tree() & refine_leaves_once_if_unbalanced(): the sample function
+            - The *_parallel() refiners: the sample function & the predicate
+            - interpolate_many()
+          Samples are always stored by the calling thread in the same order as a serial run, so the resulting tree is identical to a serial run (the
+          *_parallel() refiners give the same samples, but not the same store order).
+          @warning The sample function & predicate will be called concurrently, and so must be thread safe.  They must not throw.  The
+                   refine_leaves_*_if_cell_pred() members evaluate predicates before the tree is modified, so predicates that only query the tree are
+                   safe there.
+          @param new_thread_count Number of threads.  Use 0 for std::thread::hardware_concurrency(). Values less than 0 are treated as 1. */
+      void set_thread_count(int new_thread_count) {
+        if (new_thread_count == 0)
+          thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        else
+          thread_count = std::max(1, new_thread_count);
       }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Get the number of threads used to evaluate sample functions.  See set_thread_count(). */
+      int get_thread_count() const { return thread_count; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Set the maximum number of async sample function evaluations in flight at once.  See refine_grid_async().
+          @param new_window New maximum.  Values less than 1 are treated as 1. */
+      void set_async_window(std::size_t new_window) { async_window = std::max(static_cast<std::size_t>(1), new_window); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Get the maximum number of async sample function evaluations in flight at once. */
+      std::size_t get_async_window() const { return async_window; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Balance the tree on the fly while refining.
+          When the delta is non-negative, the scalar refine_once() ripples just like balance_tree(): after refining a cell, it refines neighbor leaves
+          left more than new_balance_delta levels coarser than the new children, and so on.  So refine_recursive_cell_pred(),
+          refine_leaves_recursive_cell_pred(), refine_leaves_once_if_cell_pred(), & refine_leaves_atomically_if_cell_pred() keep a tree balanced at
+          new_balance_delta as they go (i.e. cell_is_unbalanced(new_balance_delta, c) is false for every leaf afterwards if it was false before).  The
+          batch, async, & parallel task refiners do not balance -- use balance_tree() after them.  The ripple of refine_once() (and so of the recursive
+          predicate refiners) calls the sample function on the calling thread only, while refine_leaves_once_if_cell_pred() &
+          refine_leaves_atomically_if_cell_pred() use get_thread_count() threads for the ripple just as they do for the cells they refine.
+          @param new_balance_delta The level delta to keep.  Negative values turn balancing off (the default). */
+      void set_balance_delta(int new_balance_delta) { balance_delta = std::max(-1, new_balance_delta); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Get the level delta kept by the scalar predicate refiners.  -1 means no on the fly balancing.  See set_balance_delta(). */
+      int get_balance_delta() const { return balance_delta; }
       //@}
 
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
       /** @name Real Range Space Computation */
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Convert a range value to the stored representation (rounding to rng_store_real_t if required)
+          @param val Value in range space */
+      inline srpt_t rrpt_to_srpt(rrpt_t val) const {
+        if constexpr (std::is_same<srpt_t, rrpt_t>::value) {
+          return val;
+        } else if constexpr (rng_dim == 1) {
+          return static_cast<srt_t>(val);
+        } else {
+          srpt_t ret;
+          for(int i=0; i<rng_dim; i++)
+            ret[i] = static_cast<srt_t>(val[i]);
+          return ret;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Convert a stored range value to a range value
+          @param val Stored value */
+      inline rrpt_t srpt_to_rrpt(srpt_t val) const {
+        if constexpr (std::is_same<srpt_t, rrpt_t>::value) {
+          return val;
+        } else if constexpr (rng_dim == 1) {
+          return static_cast<src_t>(val);
+        } else {
+          rrpt_t ret;
+          for(int i=0; i<rng_dim; i++)
+            ret[i] = static_cast<src_t>(val[i]);
+          return ret;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a point in the range space contains a NaN coordinate value
           @param val Value in  space */
       inline bool rrpt_is_nan(rrpt_t val) const {
@@ -915,6 +2573,15 @@ namespace mjr {
               - Once: refine_leaves_once_if_cell_pred()
               - Repeatedly atomically: refine_leaves_atomically_if_cell_pred
               - Recursively: refine_leaves_recursive_cell_pred()
+
+          refine_once(), refine_grid(), and the refine_*_cell_pred() members also accept a batch sample function (see ::drpt2rrpt_batch_func_t).  The
+          points to sample are collected, and passed to the function in blocks (see set_sample_batch_size()).  The recursive predicate refiners work
+          breadth first when given a batch function so that an entire generation of cells is sampled together.  Use make_batch_func() to adapt a
+          scalar function.
+
+          For slow sample functions (ODE solves, external processes, etc...) the *_async() members accept a function returning a future (anything with a
+          get() member returning a value convertible to ::rrpt_t -- see ::drpt2rrpt_async_func_t).  Points are planned a generation at a time just like
+          the batch versions, up to get_async_window() evaluations are kept in flight, and results are committed in plan order as they are collected.
       */
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -922,13 +2589,19 @@ namespace mjr {
           @param cell Cell to refine -- no error checking!!
           @param func Function to use for samples
           @return 1 if cell was refined, and 0 otherwise -- i.e. the number of cells refined. */
-      bool refine_once(diti_t cell, drpt2rrpt_func_t func) {
-        auto children = ccc_get_children(cell);
-        if (children.empty()) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      bool refine_once(diti_t cell, sample_func_t&& func) {
+        if ( !(cell_can_have_children(cell))) {
           return 0;
         } else {
-          for(auto const c : children)   // ccc_get_children returns an empty list if the cell is too small to refine.
+          for(auto const c : ccc_get_children_array(cell))
             sample_cell(c, func);
+          if (balance_delta >= 0) {
+            diti_list_t ripple = leaves_unbalanced_by(std::span<const diti_t>(&cell, 1), balance_delta);
+            if ( !(ripple.empty()))
+              refine_cells_rippled(ripple, balance_delta, func, true);  // Serial: the recursive refiners call func on one thread
+          }
           return 1;
         }
       }
@@ -936,72 +2609,44 @@ namespace mjr {
       /** Sample a function uniformly across given cell to the given level.
           The given cell need not exist in the tree yet.
 
-          @warning Will resample previously sampled points in the cell.
+          @warning Will resample previously sampled points in the cell -- except after resume_from_journal(), when points that already have samples are
+                   skipped while the journal is open.
+          @warning When get_thread_count() is greater than one, func is called concurrently from several threads.
 
           @param cell        The cell to sample within
           @param level_delta The relative level at which to sample
                                level_delta=0 is equivalent to calling sample_cell(cell, func).
                                level_delta=1 is equivalent to calling sample_cell(cell, func) followed by refine_once(cell, func).
           @param func        Function to use for samples */
-      void refine_grid(diti_t cell, int level_delta, drpt2rrpt_func_t func) {
-        diti_t tmp = ccc_cell_get_corner_min(cell);
-        if constexpr (dom_dim == 1) {
-          dic_t  del = ccc_cell_half_width(cell) >> level_delta;
-          for(int i=0; i<(1 << (1+level_delta))+1; i++) {
-            sample_point(tmp, func);
-            tmp += del;
-          }
-        } else if constexpr (dom_dim == 2) {
-          dic_t  del = static_cast<dic_t>(ccc_cell_full_width(cell) >> level_delta);
-          // Corners
-          for(dic_t i=0; i<(1 << level_delta)+1; i++) {
-            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
-            for(dic_t j=0; j<(1 << level_delta)+1; j++) {
-              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
-              sample_point(tmp3, func);
-            }
-          }
-          // Centers
-          tmp = cuc_inc_all_crd(tmp, del/2);
-          for(dic_t i=0; i<(1 << level_delta); i++) {
-            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
-            for(dic_t j=0; j<(1 << level_delta); j++) {
-              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
-              sample_point(tmp3, func);
-            }
-          }
-        } else if constexpr (dom_dim == 3) {
-          dic_t  del = static_cast<dic_t>(ccc_cell_full_width(cell) >> level_delta);
-          // Corners
-          for(dic_t i=0; i<(1 << level_delta)+1; i++) {
-            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
-            for(dic_t j=0; j<(1 << level_delta)+1; j++) {
-              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
-              for(dic_t k=0; k<(1 << level_delta)+1; k++) {
-                diti_t tmp4  = cuc_inc_crd(tmp3, 2, k*del);
-                sample_point(tmp4, func);
-              }
-            }
-          }
-          // Centers
-          tmp = cuc_inc_all_crd(tmp, del/2);
-          for(dic_t i=0; i<(1 << level_delta); i++) {
-            diti_t tmp2 = cuc_inc_crd(tmp, 0, i*del);
-            for(dic_t j=0; j<(1 << level_delta); j++) {
-              diti_t tmp3  = cuc_inc_crd(tmp2, 1, j*del);
-              for(dic_t k=0; k<(1 << level_delta); k++) {
-                diti_t tmp4  = cuc_inc_crd(tmp3, 2, k*del);
-                sample_point(tmp4, func);
-              }
-            }
-          }
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void refine_grid(diti_t cell, int level_delta, sample_func_t&& func) {
+        reserve_grid_samples(level_delta);
+        if (thread_count > 1) {
+          diti_list_t pending;
+          pending.reserve(parallel_tile_size);
+          for_each_grid_point(cell, level_delta, [this, &func, &pending](diti_t diti) {
+                                                   if ( !(grid_point_wanted(diti)))
+                                                     return;
+                                                   pending.push_back(diti);
+                                                   if (pending.size() >= parallel_tile_size) {
+                                                     sample_points_parallel(pending, func);
+                                                     pending.clear();
+                                                   }
+                                                 });
+          sample_points_parallel(pending, func);
         } else {
-          std::cout << "ERROR: refine_grid with dom_dim>3 not supported (use refine_recursive)!" << std::endl;
+          for_each_grid_point(cell, level_delta, [this, &func](diti_t diti) {
+                                                   if (grid_point_wanted(diti))
+                                                     sample_point(diti, func);
+                                                 });
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      void refine_grid(int level_delta, drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void refine_grid(int level_delta, sample_func_t&& func) {
         refine_grid(ccc_get_top_cell(), level_delta, func);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1013,10 +2658,12 @@ namespace mjr {
           @param cell Cell to refine
           @param level Maximum level of refined cells.  -1 means refine to the limit.
           @param func Function to use for samples */
-      void refine_recursive(diti_t cell, int level, drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void refine_recursive(diti_t cell, int level, sample_func_t&& func) {
         sample_cell(cell, func);
-        if ((level < 0) || (ccc_cell_level(cell) < level)) {
-          for(auto const c : ccc_get_children(cell)) {
+        if (((level < 0) || (ccc_cell_level(cell) < level)) && cell_can_have_children(cell)) {
+          for(auto const c : ccc_get_children_array(cell)) {
             sample_cell(c, func);
             refine_recursive(c, level, func);
           }
@@ -1024,7 +2671,9 @@ namespace mjr {
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      void refine_recursive(int level, drpt2rrpt_func_t func) {
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void refine_recursive(int level, sample_func_t&& func) {
         refine_recursive(ccc_get_top_cell(), level, func);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1040,58 +2689,129 @@ namespace mjr {
           @param level Maximum level of refinded cells.  -1 means refine to the limit.
           @param func Function to use for samples
           @param pred Predicate function. */
-      void refine_recursive_cell_pred(diti_t cell, int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_recursive_cell_pred(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
         if ((level < 0) || (ccc_cell_level(cell) < level)) {
-          if (pred(cell)) {
-            refine_once(cell, func);
-            for(auto const c : ccc_get_children(cell)) {
+          if (pred(cell) && refine_once(cell, func)) {
+            for(auto const c : ccc_get_children_array(cell)) {
               refine_recursive_cell_pred(c, level, func, pred);
             }
           }
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Multithreaded refine_recursive_cell_pred() for trees with a concurrent sample store (MR_sharded_map).
+
+          Refinement of each child cell is a task, and get_thread_count() threads share the tasks with work stealing -- so very unbalanced (adaptive) trees
+          still keep all threads busy.  Subtrees within a few levels of the level limit are refined by one thread without creating more tasks.  Vertexes
+          shared by neighboring subtrees are sampled exactly once.  The resulting tree has the same samples as refine_recursive_cell_pred(), but the order of
+          samples in the store may differ from run to run.
+
+          @warning func & pred are called concurrently, and so must be thread safe.  They must not throw.
+          @warning If bricks are packed, then the refinement is done by the calling thread alone.
+          @note Leaf queries made during the run (by pred for example) walk the tree instead of using the leaf index, and see whatever other threads have
+                stored so far.  See get_leaf_cells().
+          @note If a journal is open, then new samples are journaled by the calling thread after the refinement finishes.  See open_journal().
+          @note If a memo file is open, then it is checked before func is called, and new results are added to it by the calling thread after the
+                refinement finishes.  See open_memo_file().
+
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Function to use for samples
+          @param pred  Predicate function.
+          @return The number of points sampled by each thread */
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t> && store_is_concurrent)
+      std::vector<std::size_t> refine_recursive_cell_pred_parallel(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
+        if ((thread_count <= 1) || (get_brick_count() > 0)) {
+          std::size_t old_count = get_sample_count();
+          refine_recursive_cell_pred(cell, level, func, pred);
+          return {get_sample_count() - old_count};
+        } else {
+          leaf_index_invalidate();
+          leaf_index.refining = true;
+          std::vector<std::size_t> sample_counts = refine_recursive_cell_pred_tasks(diti_list_t({cell}), level, func, pred);
+          leaf_index.refining = false;
+          return sample_counts;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Refine a cells matching predicate until refined cells reach specified level
           @warning cell must exist (i.e. must be sampled)
           @param cell Cell to refine
           @param level Maximum level of refinded cells.  -1 means refine to the limit.
           @param func Function to use for samples
           @param pred Predicate function. */
-      void refine_leaves_recursive_cell_pred(diti_t cell, int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
         for(auto c: get_leaf_cells(cell))
           refine_recursive_cell_pred(c, level, func, pred);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      void refine_leaves_recursive_cell_pred(int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred(int level, sample_func_t&& func, cell_pred_t&& pred) {
         refine_leaves_recursive_cell_pred(ccc_get_top_cell(), level, func, pred);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Multithreaded refine_leaves_recursive_cell_pred() for trees with a concurrent sample store (MR_sharded_map).
+          Each leaf is a seed task.  See refine_recursive_cell_pred_parallel().
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Function to use for samples
+          @param pred  Predicate function.
+          @return The number of points sampled by each thread */
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t> && store_is_concurrent)
+      std::vector<std::size_t> refine_leaves_recursive_cell_pred_parallel(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
+        if ((thread_count <= 1) || (get_brick_count() > 0)) {
+          std::size_t old_count = get_sample_count();
+          refine_leaves_recursive_cell_pred(cell, level, func, pred);
+          return {get_sample_count() - old_count};
+        } else {
+          diti_list_t seeds = get_leaf_cells(cell);
+          leaf_index_invalidate();
+          leaf_index.refining = true;
+          std::vector<std::size_t> sample_counts = refine_recursive_cell_pred_tasks(seeds, level, func, pred);
+          leaf_index.refining = false;
+          return sample_counts;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t> && store_is_concurrent)
+      std::vector<std::size_t> refine_leaves_recursive_cell_pred_parallel(int level, sample_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_recursive_cell_pred_parallel(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Refine each leaf cell if pred returns true and the cell level is less than the given level value.
 
           All leaf cells are tested with the predicate first.  Then the list of cells requiring refinement are refined.  This guarantees that no leaf cell
           will be refined more than once even if the refinement process would impact the value of the predicate.  This can produce qualitatively different
           behavior than refine_leaves_recursive_cell_pred() when used with predicates like cell_is_unbalanced().
 
+          When get_thread_count() is greater than one, the predicate and the sample function are each evaluated on several threads -- so both must be thread
+          safe.  The predicate is always evaluated before the tree is modified, so predicates that only query the tree are safe.  The resulting tree is
+          identical to a one thread run.
+
           @param cell  Input cell. Must be a valid cell. -- no error checking.
           @param level Maximum level of refinded cells.  -1 means refine to the limit.
           @param func  Function to sample
           @param pred  Predicate function. */
-      int  refine_leaves_once_if_cell_pred(diti_t cell, int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
-        diti_list_t cells_to_check  = get_leaf_cells(cell);
-        diti_list_t cells_to_refine;
-        for(auto c: cells_to_check)
-          if (pred(c))
-            if ((level < 0) || (ccc_cell_level(c) < level))
-              cells_to_refine.push_back(c);
-        int refined_count = 0;
-        for(auto c: cells_to_refine)
-          refined_count += refine_once(c, func);
-        return refined_count;
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      int  refine_leaves_once_if_cell_pred(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
+        return refine_cells_rippled(leaves_to_refine(cell, level, pred), balance_delta, func);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      int  refine_leaves_once_if_cell_pred(int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      int  refine_leaves_once_if_cell_pred(int level, sample_func_t&& func, cell_pred_t&& pred) {
         return refine_leaves_once_if_cell_pred(ccc_get_top_cell(), level, func, pred);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1103,16 +2823,241 @@ namespace mjr {
           @param level Maximum level of refinded cells.  -1 means refine to the limit.
           @param func  Function to sample
           @param pred  Predicate function. */
-      int refine_leaves_atomically_if_cell_pred(diti_t cell, int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred(diti_t cell, int level, sample_func_t&& func, cell_pred_t&& pred) {
+        int refined_count = 0;
+        while (0 < (refined_count = refine_leaves_once_if_cell_pred(cell, level, func, pred)))
+          ;
+        return refined_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class sample_func_t, class cell_pred_t>
+      requires (std::invocable<sample_func_t&, drpt_t> && std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred(int level, sample_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_atomically_if_cell_pred(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_once().
+          @param cell Cell to refine -- no error checking!!
+          @param func Batch function to use for samples
+          @return 1 if cell was refined, and 0 otherwise -- i.e. the number of cells refined. */
+      template <class batch_func_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&>)
+      bool refine_once(diti_t cell, batch_func_t&& func) {
+        return (refine_cells_planned(diti_list_t({cell}), batch_sampler(func)) > 0);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_grid().
+          @param cell        The cell to sample within
+          @param level_delta The relative level at which to sample
+          @param func        Batch function to use for samples */
+      template <class batch_func_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&>)
+      void refine_grid(diti_t cell, int level_delta, batch_func_t&& func) {
+        reserve_grid_samples(level_delta);
+        diti_list_t pending;
+        pending.reserve(sample_batch_size);
+        for_each_grid_point(cell, level_delta, [this, &func, &pending](diti_t diti) {
+                                                 if ( !(grid_point_wanted(diti)))
+                                                   return;
+                                                 pending.push_back(diti);
+                                                 if (pending.size() >= sample_batch_size) {
+                                                   sample_points_batch(pending, func);
+                                                   pending.clear();
+                                                 }
+                                               });
+        sample_points_batch(pending, func);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class batch_func_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&>)
+      void refine_grid(int level_delta, batch_func_t&& func) {
+        refine_grid(ccc_get_top_cell(), level_delta, func);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_recursive_cell_pred().  Cells are refined breadth first.
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Batch function to use for samples
+          @param pred  Predicate function. */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_recursive_cell_pred(diti_t cell, int level, batch_func_t&& func, cell_pred_t&& pred) {
+        refine_recursive_cell_pred_planned(diti_list_t({cell}), level, batch_sampler(func), pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_leaves_recursive_cell_pred().  Cells are refined breadth first.
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Batch function to use for samples
+          @param pred  Predicate function. */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred(diti_t cell, int level, batch_func_t&& func, cell_pred_t&& pred) {
+        refine_recursive_cell_pred_planned(get_leaf_cells(cell), level, batch_sampler(func), pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred(int level, batch_func_t&& func, cell_pred_t&& pred) {
+        refine_leaves_recursive_cell_pred(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_leaves_once_if_cell_pred().
+          @param cell  Input cell. Must be a valid cell. -- no error checking.
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Batch function to sample
+          @param pred  Predicate function. */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      int  refine_leaves_once_if_cell_pred(diti_t cell, int level, batch_func_t&& func, cell_pred_t&& pred) {
+        return refine_cells_planned(leaves_to_refine(cell, level, pred), batch_sampler(func));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      int  refine_leaves_once_if_cell_pred(int level, batch_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_once_if_cell_pred(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Batch version of refine_leaves_atomically_if_cell_pred().
+          @param cell  Input cell. Must be a valid cell. -- no error checking.
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Batch function to sample
+          @param pred  Predicate function. */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred(diti_t cell, int level, batch_func_t&& func, cell_pred_t&& pred) {
+        int refined_count = 0;
+        while (0 < (refined_count = refine_leaves_once_if_cell_pred(cell, level, func, pred)))
+          ;
+        return refined_count;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class batch_func_t, class cell_pred_t>
+      requires (std::invocable<batch_func_t&, const drpt_batch_t&, const rrpt_batch_t&> && std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred(int level, batch_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_atomically_if_cell_pred(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_once().
+          @param cell Cell to refine -- no error checking!!
+          @param func Async function to use for samples
+          @return 1 if cell was refined, and 0 otherwise -- i.e. the number of cells refined. */
+      template <class async_func_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; })
+      bool refine_once_async(diti_t cell, async_func_t&& func) {
+        return (refine_cells_planned(diti_list_t({cell}), async_sampler(func)) > 0);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_grid().
+          @param cell        The cell to sample within
+          @param level_delta The relative level at which to sample
+          @param func        Async function to use for samples */
+      template <class async_func_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; })
+      void refine_grid_async(diti_t cell, int level_delta, async_func_t&& func) {
+        reserve_grid_samples(level_delta);
+        diti_list_t pending;
+        pending.reserve(parallel_tile_size);
+        for_each_grid_point(cell, level_delta, [this, &func, &pending](diti_t diti) {
+                                                 if ( !(grid_point_wanted(diti)))
+                                                   return;
+                                                 pending.push_back(diti);
+                                                 if (pending.size() >= parallel_tile_size) {
+                                                   sample_points_async(pending, func);
+                                                   pending.clear();
+                                                 }
+                                               });
+        sample_points_async(pending, func);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class async_func_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; })
+      void refine_grid_async(int level_delta, async_func_t&& func) {
+        refine_grid_async(ccc_get_top_cell(), level_delta, func);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_recursive_cell_pred().  Cells are refined breadth first.
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Async function to use for samples
+          @param pred  Predicate function. */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      void refine_recursive_cell_pred_async(diti_t cell, int level, async_func_t&& func, cell_pred_t&& pred) {
+        refine_recursive_cell_pred_planned(diti_list_t({cell}), level, async_sampler(func), pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_leaves_recursive_cell_pred().  Cells are refined breadth first.
+          @param cell  Cell to refine
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Async function to use for samples
+          @param pred  Predicate function. */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred_async(diti_t cell, int level, async_func_t&& func, cell_pred_t&& pred) {
+        refine_recursive_cell_pred_planned(get_leaf_cells(cell), level, async_sampler(func), pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      void refine_leaves_recursive_cell_pred_async(int level, async_func_t&& func, cell_pred_t&& pred) {
+        refine_leaves_recursive_cell_pred_async(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_leaves_once_if_cell_pred().
+          @param cell  Input cell. Must be a valid cell. -- no error checking.
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Async function to sample
+          @param pred  Predicate function. */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_once_if_cell_pred_async(diti_t cell, int level, async_func_t&& func, cell_pred_t&& pred) {
+        return refine_cells_planned(leaves_to_refine(cell, level, pred), async_sampler(func));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_once_if_cell_pred_async(int level, async_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_once_if_cell_pred_async(ccc_get_top_cell(), level, func, pred);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Async version of refine_leaves_atomically_if_cell_pred().
+          @param cell  Input cell. Must be a valid cell. -- no error checking.
+          @param level Maximum level of refinded cells.  -1 means refine to the limit.
+          @param func  Async function to sample
+          @param pred  Predicate function. */
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred_async(diti_t cell, int level, async_func_t&& func, cell_pred_t&& pred) {
         int refined_count = 0;
-        while (0 < (refined_count = refine_leaves_once_if_cell_pred(cell, level, func, pred)))
+        while (0 < (refined_count = refine_leaves_once_if_cell_pred_async(cell, level, func, pred)))
           ;
         return refined_count;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
-      int refine_leaves_atomically_if_cell_pred(int level, drpt2rrpt_func_t func, diti2bool_func_t pred) {
-        return refine_leaves_atomically_if_cell_pred(ccc_get_top_cell(), level, func, pred);
+      template <class async_func_t, class cell_pred_t>
+      requires (std::invocable<async_func_t&, drpt_t> && requires(std::invoke_result_t<async_func_t&, drpt_t> f) { { f.get() } -> std::convertible_to<rrpt_t>; } &&
+                std::predicate<cell_pred_t&, diti_t>)
+      int refine_leaves_atomically_if_cell_pred_async(int level, async_func_t&& func, cell_pred_t&& pred) {
+        return refine_leaves_atomically_if_cell_pred_async(ccc_get_top_cell(), level, func, pred);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Refine a cells with NaNs until refined cells reach specified level
@@ -1121,8 +3066,10 @@ namespace mjr {
 
           @param level Maximum level of refinded cells.  -1 means refine to the limit.
           @param func Function to use for samples */
-      void refine_recursive_if_cell_vertex_is_nan(int level, drpt2rrpt_func_t func) {
-        refine_leaves_recursive_cell_pred(level, func, std::bind_front(&MR_rect_tree::cell_vertex_is_nan, this));
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void refine_recursive_if_cell_vertex_is_nan(int level, sample_func_t&& func) {
+        refine_leaves_recursive_cell_pred(level, func, [this](diti_t c) { return cell_vertex_is_nan(c); });
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Refine leaf cells if they are unbalanced at the given level.
@@ -1133,18 +3080,29 @@ namespace mjr {
 
           @param level_delta The Level.
           @param func        Function to sample */
-      int refine_leaves_once_if_unbalanced(int level_delta, drpt2rrpt_func_t func) {
-        return refine_leaves_once_if_cell_pred(ccc_get_top_cell(), -1, func, std::bind_front(&cell_is_unbalanced, this, level_delta));
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      int refine_leaves_once_if_unbalanced(int level_delta, sample_func_t&& func) {
+        return refine_leaves_once_if_cell_pred(ccc_get_top_cell(), -1, func, [this, level_delta](diti_t c) { return cell_is_unbalanced(level_delta, c); });
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Balance the cell to the given level.
 
-          This is a convenience function combining refine_leaves_atomically_if_cell_pred(), cell_is_unbalanced(), & ccc_get_top_cell().
+          One sweep of the leaves finds the unbalanced ones (see cell_is_unbalanced()).  They are refined, and then the refinement ripples outward: only
+          face neighbors of newly refined cells are checked and refined, until no cell is unbalanced.  The total work is proportional to the number of leaves
+          plus the number of cells refined -- not the number of leaves times the number of passes.  The result is the same tree as repeated
+          refine_leaves_atomically_if_cell_pred() passes with cell_is_unbalanced().  Negative level_delta values use the repeated passes.
 
           @param level_delta  The Level.
           @param func         Function to sample */
-      void balance_tree(int level_delta, drpt2rrpt_func_t func) {
-        refine_leaves_atomically_if_cell_pred(ccc_get_top_cell(), -1, func, std::bind_front(&this_t::cell_is_unbalanced, this, level_delta));
+      template <class sample_func_t>
+      requires (std::invocable<sample_func_t&, drpt_t>)
+      void balance_tree(int level_delta, sample_func_t&& func) {
+        auto unbalanced = [this, level_delta](diti_t c) { return cell_is_unbalanced(level_delta, c); };
+        if (level_delta < 0)
+          refine_leaves_atomically_if_cell_pred(ccc_get_top_cell(), -1, func, unbalanced);
+        else
+          refine_cells_rippled(leaves_to_refine(ccc_get_top_cell(), -1, unbalanced), level_delta, func);
       }
       //@}
 
@@ -1172,6 +3130,16 @@ namespace mjr {
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if integer coordinates are those of a cell center
+          Unlike cell_good_cords(), this also checks that every coordinate is an odd multiple of the same power of two (the cell half width).
+          @param cell Input coordinates */
+      inline bool cell_good_center(diti_t cell) const {
+        const diti_t hw = static_cast<diti_t>(cell & (~cell+static_cast<diti_t>(1)));
+        if ((hw == 0) || (hw > dic_ctr))
+          return false;
+        return ((cell & static_cast<diti_t>(diti_all_units * static_cast<diti_t>(2*hw-1))) == static_cast<diti_t>(diti_all_units * hw));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell has been sampled.
           @warning Simply checks that cell has been sampled -- identical to vertex_exists().
           @param cell Input cell*/
@@ -1183,21 +3151,21 @@ namespace mjr {
           @warning Simply checks that cell has been sampled -- identical to vertex_exists().
           @param cell Input cell*/
       inline bool cell_is_sampled(diti_t cell) const {
-        diti_list_t verts = ccc_get_vertexes(cell);
+        diti_vertexes_t verts = ccc_get_vertexes_array(cell);
         return (std::all_of(verts.cbegin(), verts.cend(), [this](diti_t i) { return (vertex_exists(i)); }));
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell has a vertex with a NaN value for a sample
           @param cell Input cell */
-      inline bool cell_vertex_is_nan(diti_t cell) {
-        diti_list_t verts = ccc_get_vertexes(cell);
+      inline bool cell_vertex_is_nan(diti_t cell) const {
+        diti_vertexes_t verts = ccc_get_vertexes_array(cell);
         return (std::any_of(verts.cbegin(), verts.cend(), [this](diti_t i) { return (vertex_is_nan(i)); }));
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell has an corner with a NaN value for a sample
           @param cell Input cell */
-      inline bool cell_corner_is_nan(diti_t cell) {
-        diti_list_t corners = ccc_get_corners(cell);
+      inline bool cell_corner_is_nan(diti_t cell) const {
+        diti_corners_t corners = ccc_get_corners_array(cell);
         return (std::any_of(corners.cbegin(), corners.cend(), [this](diti_t i) { return (vertex_is_nan(i)); }));
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1225,7 +3193,7 @@ namespace mjr {
           @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
           @param direction The direction on the given index.  Must be 1 or -1.  No error checking.
           @param cell Input cell */
-      inline bool cell_has_neighbor(diti_t cell, int index, int direction) {
+      inline bool cell_has_neighbor(diti_t cell, int index, int direction) const {
         diti_t tmp = ccc_get_neighbor(cell, index, direction);
         if (tmp)
           return cell_is_sampled(cell);
@@ -1239,7 +3207,9 @@ namespace mjr {
           @param cell Input Cell
           @param sdf Signed distance function
           @return true if the cell crosses, or is on, the signed distance function boundry. */
-      inline bool cell_cross_sdf(diti_t cell, drpt2real_func_t sdf) {
+      template <class sdf_func_t>
+      requires (std::invocable<sdf_func_t&, drpt_t>)
+      inline bool cell_cross_sdf(diti_t cell, sdf_func_t&& sdf) const {
         /* The algorithm below directly expresses the RHS of the following iff which is equivalent to the LHS (and the statement in the documentation).
            @f[
            (\mathrm{sgn}(\vec{\mathbf{c}})=0)\lor(\exists \vec{\mathbf{v}}\in E(\vec{\mathbf{c}})\,\mathrm{st}\,\mathrm{sgn}(\vec{\mathbf{c}})\ne\mathrm{sgn}(\vec{\mathbf{v}}))
@@ -1252,7 +3222,7 @@ namespace mjr {
         int center_sign = mjr::math::sfun::sgn(sdf(diti_to_drpt(cell)));
         if (center_sign == 0)
           return true;
-        for(diti_t& v: ccc_get_corners(cell))
+        for(auto const v: ccc_get_corners_array(cell))
           if (center_sign != mjr::math::sfun::sgn(sdf(diti_to_drpt(v))))
             return true;
         return false;
@@ -1263,7 +3233,7 @@ namespace mjr {
           @param epsilon      How close the point must be
           @param cell Input Cell
           @return true if a cell contains, or is close to, a domain_point. */
-      inline bool cell_near_domain_point(drpt_t domain_point, src_t epsilon, diti_t cell) {
+      inline bool cell_near_domain_point(drpt_t domain_point, src_t epsilon, diti_t cell) const {
         drpt_t min_drpt = diti_to_drpt(ccc_cell_get_corner_min(cell));
         for(int i=0; i<dom_dim; i++)
           if (dom_at(min_drpt, i)-epsilon > dom_at(domain_point, i))
@@ -1281,7 +3251,7 @@ namespace mjr {
           @param domain_level The level, or value, of the domain component we are testing
           @param epsilon      Used to fuzz floating point comparisons
           @return true if the cell crosses the domain level. */
-      inline bool cell_near_domain_level(diti_t cell, int domain_index, src_t domain_level, src_t epsilon) {
+      inline bool cell_near_domain_level(diti_t cell, int domain_index, src_t domain_level, src_t epsilon) const {
         return ( (dom_at(diti_to_drpt(ccc_cell_get_corner_min(cell)), domain_index) < domain_level+epsilon) &&
                  (dom_at(diti_to_drpt(ccc_cell_get_corner_max(cell)), domain_index) > domain_level-epsilon) );
       }
@@ -1291,7 +3261,7 @@ namespace mjr {
           @param domain_index The index of the domain component we are testing
           @param domain_level The level, or value, of the domain component we are testing
           @return true if the cell below the domain level. */
-      inline bool cell_below_domain_level(diti_t cell, int domain_index, src_t domain_level) {
+      inline bool cell_below_domain_level(diti_t cell, int domain_index, src_t domain_level) const {
         return (dom_at(diti_to_drpt(ccc_cell_get_corner_max(cell)), domain_index) < domain_level);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -1300,22 +3270,62 @@ namespace mjr {
           @param domain_index The index of the domain component we are testing
           @param domain_level The level, or value, of the domain component we are testing
           @return true if the cell above the domain level. */
-      inline bool cell_above_domain_level(diti_t cell, int domain_index, src_t domain_level) {
+      inline bool cell_above_domain_level(diti_t cell, int domain_index, src_t domain_level) const {
         return ((dom_at(diti_to_drpt(ccc_cell_get_corner_min(cell)), domain_index) > domain_level));
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Subtree form of cell_near_domain_point() for leaves_pruned().
+          A cell's box contains the boxes of all its descendants, so the leaf test is already conservative for a subtree.
+          @param domain_point The point in the domain
+          @param epsilon      How close the point must be
+          @param cell Input Cell
+          @return true if some leaf under the cell might be near the point. */
+      inline bool subtree_near_domain_point(drpt_t domain_point, src_t epsilon, diti_t cell) const {
+        return cell_near_domain_point(domain_point, epsilon, cell);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Subtree form of cell_near_domain_level() for leaves_pruned().
+          @param cell Input Cell
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing
+          @param epsilon      Used to fuzz floating point comparisons
+          @return true if some leaf under the cell might cross the domain level. */
+      inline bool subtree_near_domain_level(diti_t cell, int domain_index, src_t domain_level, src_t epsilon) const {
+        return cell_near_domain_level(cell, domain_index, domain_level, epsilon);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Subtree form of cell_below_domain_level() for leaves_pruned().
+          Unlike the leaf test, only part of the cell need be below the level.
+          @param cell Input Cell
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing
+          @return true if some leaf under the cell might be below the domain level. */
+      inline bool subtree_below_domain_level(diti_t cell, int domain_index, src_t domain_level) const {
+        return (dom_at(diti_to_drpt(ccc_cell_get_corner_min(cell)), domain_index) < domain_level);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Subtree form of cell_above_domain_level() for leaves_pruned().
+          Unlike the leaf test, only part of the cell need be above the level.
+          @param cell Input Cell
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing
+          @return true if some leaf under the cell might be above the domain level. */
+      inline bool subtree_above_domain_level(diti_t cell, int domain_index, src_t domain_level) const {
+        return (dom_at(diti_to_drpt(ccc_cell_get_corner_max(cell)), domain_index) > domain_level);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell crosses the given range component value.
           See ::cell_cross_sdf for algorithm notes.
           @param cell Input Cell
           @param range_index The index of the range component we are testing
           @param range_level The level, or value, of the range component we are testing
           @return true if the cell crosses the range level. */
-      inline bool cell_cross_range_level(diti_t cell, int range_index, src_t range_level) {
-        int center_sign = mjr::math::sfun::sgn(rng_at(samples[cell], range_index)-range_level);
+      inline bool cell_cross_range_level(diti_t cell, int range_index, src_t range_level) const {
+        int center_sign = mjr::math::sfun::sgn(get_sample_component(cell, range_index)-range_level);
         if (center_sign == 0)
           return true;
-        for(diti_t& v: ccc_get_corners(cell))
-          if (center_sign != mjr::math::sfun::sgn(rng_at(samples[v], range_index)-range_level))
+        for(auto const v: ccc_get_corners_array(cell))
+          if (center_sign != mjr::math::sfun::sgn(get_sample_component(v, range_index)-range_level))
             return true;
         return false;
       }
@@ -1325,9 +3335,9 @@ namespace mjr {
           @param range_index The index of the range component we are testing
           @param range_level The level, or value, of the range component we are testing
           @return true if the cell is below the range level. */
-      inline bool cell_below_range_level(diti_t cell, int range_index, src_t range_level) {
-        diti_list_t verts = ccc_get_vertexes(cell);
-        return std::all_of(verts.cbegin(), verts.cend(), [this, range_index, range_level](int i) { return (rng_at(samples[i], range_index) < range_level); });
+      inline bool cell_below_range_level(diti_t cell, int range_index, src_t range_level) const {
+        diti_vertexes_t verts = ccc_get_vertexes_array(cell);
+        return std::all_of(verts.cbegin(), verts.cend(), [this, range_index, range_level](diti_t i) { return (get_sample_component(i, range_index) < range_level); });
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell is above given range component value
@@ -1335,23 +3345,63 @@ namespace mjr {
           @param range_index The index of the range component we are testing
           @param range_level The level, or value, of the range component we are testing
           @return true if the cell is above the range level. */
-      inline bool cell_above_range_level(diti_t cell, int range_index, src_t range_level) {
-        diti_list_t verts = ccc_get_vertexes(cell);
-        return std::all_of(verts.cbegin(), verts.cend(), [this, range_index, range_level](int i) { return (rng_at(samples[i], range_index) > range_level); });
+      inline bool cell_above_range_level(diti_t cell, int range_index, src_t range_level) const {
+        diti_vertexes_t verts = ccc_get_vertexes_array(cell);
+        return std::all_of(verts.cbegin(), verts.cend(), [this, range_index, range_level](diti_t i) { return (get_sample_component(i, range_index) > range_level); });
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if a neighbor of a cell has a leaf deeper than the given level on the shared face.
+          i.e. the same as get_smallest_neighbor_level(cell) > level, but without walking the neighbor subtrees.  A leaf deeper than level is on the face
+          exactly when a cell at level+1 is on the face, so only the centers of the possible level+1 cells along each face are probed -- at most
+          2^((level+1-ccc_cell_level(cell))*(dom_dim-1)) vertex_exists() calls per face, with an early exit on the first hit.  Like cell_has_child(), this
+          assumes the tree is well formed.
+          @param cell  Input Cell
+          @param level The level
+          @return true if a neighbor of cell has a leaf deeper than level on the shared face */
+      bool cell_neighbor_level_exceeds(diti_t cell, int level) const {
+        const int cell_level  = static_cast<int>(ccc_cell_level(cell));
+        const int probe_level = std::max(level+1, cell_level);
+        if (probe_level > max_level-1)
+          return false;
+        const int steps_bits = probe_level - cell_level;  // log2 of the number of probe cells along each axis of a face
+        if (steps_bits * (dom_dim-1) > 16)                 // Too many probes.  Walk the subtrees instead.
+          return (get_smallest_neighbor_level(cell) > level);
+        const dic_t       hw     = ccc_cell_half_width(cell);
+        const dic_t       phw    = static_cast<dic_t>(hw >> steps_bits);
+        const diti_t      steps  = static_cast<diti_t>(1) << steps_bits;
+        const std::size_t probes = static_cast<std::size_t>(1) << (steps_bits * (dom_dim-1));
+        for(int aix=0; aix<dom_dim; aix++) {
+          for(int dir=-1; dir<2; dir+=2) {
+            diti_t nbr = ccc_get_neighbor(cell, aix, dir);
+            if (nbr != 0) {
+              diti_t base = cuc_dec_all_crd(nbr, static_cast<dic_t>(hw-phw));  // The probe cell at the minimum corner of the neighbor
+              if (dir < 0)
+                base = cuc_inc_crd(base, aix, static_cast<dic_t>(2*(hw-phw)));  // Move to the face shared with cell
+              for(std::size_t p=0; p<probes; p++) {
+                diti_t probe = base;
+                std::size_t q = p;
+                for(int j=0; j<dom_dim; j++) {
+                  if (j != aix) {
+                    probe = cuc_inc_crd(probe, j, static_cast<dic_t>(2 * phw * (q & (steps-1))));
+                    q >>= steps_bits;
+                  }
+                }
+                if (vertex_exists(probe))
+                  return true;
+              }
+            }
+          }
+        }
+        return false;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a cell is unbalanced at the given level
+          i.e. a neighbor has a leaf on the shared face more than level_delta levels deeper than cell.  See: cell_neighbor_level_exceeds()
           @param cell        Input Cell
           @param level_delta Signed distance function
           @return true if the cell is unbalanced at the given level. */
-      bool cell_is_unbalanced(int level_delta, diti_t cell) {
-        //  MJR TODO NOTE <2024-07-11T16:04:10-0500> cell_is_unbalanced: Optimize run time (nix the use of get_smallest_neighbor_level)
-        int max_level_neighbor     = get_smallest_neighbor_level(cell);
-        int current_ccc_cell_level = ccc_cell_level(cell);
-        if (max_level_neighbor > current_ccc_cell_level+level_delta)
-          return true;
-        else
-          return false;
+      bool cell_is_unbalanced(int level_delta, diti_t cell) const {
+        return cell_neighbor_level_exceeds(cell, ccc_cell_level(cell)+level_delta);
       }
       //@}
 
@@ -1361,18 +3411,14 @@ namespace mjr {
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Test if a vertex is NaN or, when it is an std::array, if it contains a NaN element
           @param vertex Input vertex */
-      inline bool vertex_is_nan(diti_t vertex) {
-        if constexpr (rng_dim == 1) {
-          return std::isnan(samples[vertex]);
-        } else {
-          return (std::any_of(samples[vertex].cbegin(), samples[vertex].cend(), [this](src_t v) { return (std::isnan(v)); }));
-        }
+      inline bool vertex_is_nan(diti_t vertex) const {
+        return rrpt_is_nan(get_sample(vertex));
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Point has been sampled.
           @param vertex Input vertex */
       inline bool vertex_exists(diti_t vertex) const {
-        return (samples.contains(vertex));
+        return (sample_exists(vertex));
       }
       //@}
 
@@ -1381,18 +3427,35 @@ namespace mjr {
       //@{
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Extract a list of all leaf cells starting from the given cell
+          The first leaf query walks the tree to build a leaf index, and it is kept up to date as the tree is refined after that -- so later calls need no
+          tree walk.  The order is depth first with children in ccc_get_children_array() order (the same order as append_leaf_cells()).
           @param cell Starting cell */
       diti_list_t get_leaf_cells(diti_t cell) const {
-        diti_list_t rv;
+        if ( !(cell_has_child(cell)))
+          return diti_list_t({cell});
+        if (leaf_index.refining) {
+          diti_list_t leaves;
+          append_leaf_cells(cell, leaves);
+          return leaves;
+        }
+        std::lock_guard<std::mutex> guard(leaf_index.lock);
+        leaf_index_sync();
+        if (cell == ccc_get_top_cell())
+          return leaf_index.cells;
+        auto [first, last] = leaf_index_range(cell);
+        return diti_list_t(first, last);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Append all leaf cells starting from the given cell to a list
+          @param cell   Starting cell
+          @param leaves List to which leaf cells are appended */
+      void append_leaf_cells(diti_t cell, diti_list_t& leaves) const {
         if (cell_has_child(cell)) {
-          for(auto const c : ccc_get_children(cell)) {
-            auto mv = get_leaf_cells(c);
-            std::move(mv.begin(), mv.end(), std::back_inserter(rv));
-          }
+          for(auto const c : ccc_get_children_array(cell))
+            append_leaf_cells(c, leaves);
         } else {
-          rv.push_back(cell);
+          leaves.push_back(cell);
         }
-        return rv;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** @overload */
@@ -1400,11 +3463,47 @@ namespace mjr {
         return get_leaf_cells(ccc_get_top_cell());
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells starting from the given cell, with a level in [level_min, level_max].
+          Unlike get_leaf_cells(), no list is built.  Without a level_max the range scans the leaf index in place, and otherwise the tree is walked as the
+          range is iterated.  See leaf_range_t.
+          @param cell      Starting cell
+          @param level_min Minimum level of leaf cells to visit
+          @param level_max Maximum level of leaf cells to visit.  Cells at this level are not descended into.  -1 means no limit. */
+      leaf_range_t<> leaves(diti_t cell, int level_min = 0, int level_max = -1) const {
+        return leaf_range_t<>(this, cell, level_min, level_max, leaf_any_t());
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      leaf_range_t<> leaves() const {
+        return leaves(ccc_get_top_cell());
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells starting from the given cell, with a level in [level_min, level_max], that match the given predicate.
+          The lazy version of get_leaf_cells_pred().  The predicate is copied into the range.  See leaves().
+          @param cell      Starting cell
+          @param pred      Predicate function.
+          @param level_min Minimum level of leaf cells to visit
+          @param level_max Maximum level of leaf cells to visit.  -1 means no limit. */
+      template <class cell_pred_t>
+      requires (std::predicate<cell_pred_t&, diti_t>)
+      leaf_range_t<std::decay_t<cell_pred_t>> leaves_pred(diti_t cell, cell_pred_t&& pred, int level_min = 0, int level_max = -1) const {
+        return leaf_range_t<std::decay_t<cell_pred_t>>(this, cell, level_min, level_max, std::forward<cell_pred_t>(pred));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class cell_pred_t>
+      requires (std::predicate<cell_pred_t&, diti_t>)
+      leaf_range_t<std::decay_t<cell_pred_t>> leaves_pred(cell_pred_t&& pred) const {
+        return leaves_pred(ccc_get_top_cell(), std::forward<cell_pred_t>(pred));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Extract a list of all leaf cells starting from the given cell that match the given predicate
           @warning The given cell need not match the predicate.
           @param cell Starting cell
           @param pred Predicate function. */
-      diti_list_t get_leaf_cells_pred(diti_t cell, diti2bool_func_t pred) const {
+      template <class cell_pred_t>
+      requires (std::predicate<cell_pred_t&, diti_t>)
+      diti_list_t get_leaf_cells_pred(diti_t cell, cell_pred_t&& pred) const {
         diti_list_t cells_to_return;
         for(auto c: get_leaf_cells(cell))
           if (pred(c))
@@ -1412,36 +3511,143 @@ namespace mjr {
         return cells_to_return;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells starting from the given cell, with a level in [level_min, level_max], that match the given predicate -- skipping
+          every subtree rooted at an internal cell for which subtree_pred is false.
+          subtree_pred must be conservative: if any leaf under a cell matches pred, then subtree_pred must be true for that cell.  The subtree_* geometric
+          predicates (ex: subtree_near_domain_point()) pair with the cell_* predicates in this way.  See leaf_range_t.
+          @param cell         Starting cell
+          @param subtree_pred Subtree predicate.  Evaluated on internal cells only.
+          @param pred         Leaf predicate.  Evaluated on leaf cells only.
+          @param level_min    Minimum level of leaf cells to visit
+          @param level_max    Maximum level of leaf cells to visit.  -1 means no limit. */
+      template <class subtree_pred_t, class cell_pred_t>
+      requires (std::predicate<subtree_pred_t&, diti_t> && std::predicate<cell_pred_t&, diti_t>)
+      pruned_leaf_range_t<cell_pred_t, subtree_pred_t> leaves_pruned(diti_t cell, subtree_pred_t&& subtree_pred, cell_pred_t&& pred,
+                                                                     int level_min = 0, int level_max = -1) const {
+        return pruned_leaf_range_t<cell_pred_t, subtree_pred_t>(this, cell, level_min, level_max,
+                                                                std::forward<cell_pred_t>(pred), std::forward<subtree_pred_t>(subtree_pred));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class subtree_pred_t, class cell_pred_t>
+      requires (std::predicate<subtree_pred_t&, diti_t> && std::predicate<cell_pred_t&, diti_t>)
+      pruned_leaf_range_t<cell_pred_t, subtree_pred_t> leaves_pruned(subtree_pred_t&& subtree_pred, cell_pred_t&& pred) const {
+        return leaves_pruned(ccc_get_top_cell(), std::forward<subtree_pred_t>(subtree_pred), std::forward<cell_pred_t>(pred));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Extract a list of all leaf cells starting from the given cell that match pred, skipping subtrees that fail subtree_pred.
+          Same result as get_leaf_cells_pred(cell, pred) when subtree_pred is conservative, but only the subtrees passing subtree_pred are walked.
+          See leaves_pruned().
+          @param cell         Starting cell
+          @param subtree_pred Subtree predicate.  Evaluated on internal cells only.
+          @param pred         Leaf predicate.  Evaluated on leaf cells only. */
+      template <class subtree_pred_t, class cell_pred_t>
+      requires (std::predicate<subtree_pred_t&, diti_t> && std::predicate<cell_pred_t&, diti_t>)
+      diti_list_t get_leaf_cells_pruned(diti_t cell, subtree_pred_t&& subtree_pred, cell_pred_t&& pred) const {
+        diti_list_t cells_to_return;
+        for(auto c: leaves_pruned(cell, std::forward<subtree_pred_t>(subtree_pred), std::forward<cell_pred_t>(pred)))
+          cells_to_return.push_back(c);
+        return cells_to_return;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      template <class subtree_pred_t, class cell_pred_t>
+      requires (std::predicate<subtree_pred_t&, diti_t> && std::predicate<cell_pred_t&, diti_t>)
+      diti_list_t get_leaf_cells_pruned(subtree_pred_t&& subtree_pred, cell_pred_t&& pred) const {
+        return get_leaf_cells_pruned(ccc_get_top_cell(), std::forward<subtree_pred_t>(subtree_pred), std::forward<cell_pred_t>(pred));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells for which cell_near_domain_point() is true.  Only subtrees near the point are walked.
+          @param domain_point The point in the domain
+          @param epsilon      How close the point must be */
+      auto leaves_near_domain_point(drpt_t domain_point, src_t epsilon) const {
+        return leaves_pruned([this, domain_point, epsilon](diti_t c) { return subtree_near_domain_point(domain_point, epsilon, c); },
+                             [this, domain_point, epsilon](diti_t c) { return cell_near_domain_point(domain_point, epsilon, c); });
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells for which cell_near_domain_level() is true.  Only subtrees crossing the level are walked.
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing
+          @param epsilon      Used to fuzz floating point comparisons */
+      auto leaves_near_domain_level(int domain_index, src_t domain_level, src_t epsilon) const {
+        return leaves_pruned([this, domain_index, domain_level, epsilon](diti_t c) {
+                               return subtree_near_domain_level(c, domain_index, domain_level, epsilon); },
+                             [this, domain_index, domain_level, epsilon](diti_t c) {
+                               return cell_near_domain_level(c, domain_index, domain_level, epsilon); });
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells for which cell_below_domain_level() is true.  Subtrees entirely above the level are skipped.
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing */
+      auto leaves_below_domain_level(int domain_index, src_t domain_level) const {
+        return leaves_pruned([this, domain_index, domain_level](diti_t c) { return subtree_below_domain_level(c, domain_index, domain_level); },
+                             [this, domain_index, domain_level](diti_t c) { return cell_below_domain_level(c, domain_index, domain_level); });
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Range of the leaf cells for which cell_above_domain_level() is true.  Subtrees entirely below the level are skipped.
+          @param domain_index The index of the domain component we are testing
+          @param domain_level The level, or value, of the domain component we are testing */
+      auto leaves_above_domain_level(int domain_index, src_t domain_level) const {
+        return leaves_pruned([this, domain_index, domain_level](diti_t c) { return subtree_above_domain_level(c, domain_index, domain_level); },
+                             [this, domain_index, domain_level](diti_t c) { return cell_above_domain_level(c, domain_index, domain_level); });
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Extract a list of all leaf cells starting from the given cell
           @param cell      Input cell. Must be a valid cell. -- no error checking.
           @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
           @param direction The direction on the given index.  Must be 1 or -1.  No error checking. */
       diti_list_t get_leaf_cells(diti_t cell, int index, int direction) const {
         diti_list_t rv;
+        append_leaf_cells(cell, index, direction, rv);
+        return rv;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Append all leaf cells starting from the given cell on the given face to a list
+          @param cell      Input cell. Must be a valid cell. -- no error checking.
+          @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
+          @param direction The direction on the given index.  Must be 1 or -1.  No error checking.
+          @param leaves    List to which leaf cells are appended */
+      void append_leaf_cells(diti_t cell, int index, int direction, diti_list_t& leaves) const {
         if (cell_has_child(cell)) {
-          for(auto const c : ccc_get_children(cell, index, direction)) {
-            auto mv = get_leaf_cells(c, index, direction);
-            std::move(mv.begin(), mv.end(), std::back_inserter(rv));
-          }
+          for(auto const c : ccc_get_children_array(cell, index, direction))
+            append_leaf_cells(c, index, direction, leaves);
         } else {
-          rv.push_back(cell);
+          leaves.push_back(cell);
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Maximum level of the leaf cells on the given face of the given cell -- i.e. the level of the smallest cell returned by get_leaf_cells(cell, index, direction).
+          @param cell      Input cell. Must be a valid cell. -- no error checking.
+          @param index     The index of the axis.  Must be in [0, dom_dim-1].  No error checking.
+          @param direction The direction on the given index.  Must be 1 or -1.  No error checking. */
+      int get_max_leaf_level(diti_t cell, int index, int direction) const {
+        if (cell_has_child(cell)) {
+          int rv = -1;
+          for(auto const c : ccc_get_children_array(cell, index, direction))
+            rv = std::max(rv, get_max_leaf_level(c, index, direction));
+          return rv;
+        } else {
+          return ccc_cell_level(cell);
         }
-        return rv;
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Count the number of leaf cells starting from the given cell
+          O(1) for the top cell, and logarithmic in the number of leaves plus the count for other cells, once the leaf index is built.  See get_leaf_cells().
           @param cell Starting cell */
       int count_leaf_cells(diti_t cell) const {
-        int rv=0;
-        if (cell_has_child(cell)) {
-          for(auto const c : ccc_get_children(cell)) {
-            int mv = count_leaf_cells(c);
-            rv+=mv;
-          }
-        } else {
-          rv++;
+        if ( !(cell_has_child(cell)))
+          return 1;
+        if (leaf_index.refining)
+          return static_cast<int>(get_leaf_cells(cell).size());
+        std::lock_guard<std::mutex> guard(leaf_index.lock);
+        if (cell == ccc_get_top_cell()) {
+          if ( !(leaf_index.valid))
+            leaf_index_sync();
+          return static_cast<int>(leaf_index.count);
         }
-        return rv;
+        leaf_index_sync();
+        auto [first, last] = leaf_index_range(cell);
+        return static_cast<int>(last - first);
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Return a list of sampled neighbors to the given cell.
@@ -1473,12 +3679,7 @@ namespace mjr {
             diti_t nbr0 = ccc_get_neighbor(cell, aix, dir);
             if ( (nbr0!=0) && cell_exists(nbr0)) {
               if (cell_has_child(nbr0)) {
-                diti_list_t nbr_leafs = get_leaf_cells(nbr0, aix, -dir);
-                for(auto nbr_leaf: nbr_leafs) {
-                  int nbr_leaf_lvl = ccc_cell_level(nbr_leaf);
-                  if (nbr_leaf_lvl > maximum_level)
-                    maximum_level = nbr_leaf_lvl;
-                }
+                maximum_level = std::max(maximum_level, get_max_leaf_level(nbr0, aix, -dir));
               } else {
                 if (start_level > maximum_level)
                   maximum_level = start_level;
@@ -1490,6 +3691,478 @@ namespace mjr {
       }
       //@}
 
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Point Location & Interpolation
+
+          Evaluate the sampled field at arbitrary points of the domain -- so a tree may be used as a cheap surrogate for an expensive sample function.
+
+          A point is located by quantizing it to integer coordinates, and then finding the level of the leaf holding it with a binary search over levels.
+          Each step of the search is one vertex_exists() probe, so a point is located with about log2(max_level) probes.  Like cell_has_child(), these
+          members assume the tree is well formed.
+
+          Two interpolation schemes are provided:
+            - Multilinear interpolation from the 2^dom_dim corners of the leaf.
+            - Center aware interpolation (the default).  The leaf is split into 2*dom_dim pyramids -- one for each face with the apex at the center.  A point
+              is projected from the center onto the face of its pyramid, the face value is multilinear in the face corners, and the result is linear
+              between the center & face values.  For dom_dim==2 this is linear interpolation on the triangle fan used by MR_rt_to_cc::construct_geometry_fans().
+              The result matches multilinear interpolation on the faces of the leaf, and uses the center sample inside. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find the leaf cell holding a point.
+          Points on the boundary between leaves may be placed in either leaf.  Points outside of the bounding box by less than half of the width of a
+          max_level cell are treated as being on the boundary.
+          @param domain_point The point in the domain
+          @return The leaf cell, or 0 if the point is outside of the bounding box or the tree is empty */
+      diti_t locate_leaf(drpt_t domain_point) const {
+        diti_t diti = 0;
+        bool   good = true;
+        for(int i=0; i<dom_dim; i++)
+          diti = cuc_inc_crd(diti, i, drpt_crd_to_dic(domain_point, i, good));
+        if (good)
+          return locate_leaf_diti(diti);
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Interpolate the sampled field at a point.
+          @param domain_point The point in the domain
+          @param use_center   Use center aware interpolation if true, and multilinear interpolation otherwise
+          @return The interpolated value, or NaN if the point is outside of the bounding box or the tree is empty */
+      rrpt_t interpolate(drpt_t domain_point, bool use_center = true) const {
+        diti_t leaf = locate_leaf(domain_point);
+        if (leaf == 0) {
+          rrta_t rv;
+          rv.fill(std::numeric_limits<src_t>::quiet_NaN());
+          return rrta_to_rrpt(rv);
+        }
+        return rrta_to_rrpt(interpolate_in_leaf(leaf, domain_point, use_center));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Interpolate the sampled field at many points.
+          The points & results are given as columns, exactly like the arguments of a batch sample function (see ::drpt2rrpt_batch_func_t).  Points are
+          processed in tiles: all points in a tile are quantized with simple loops over the coordinate columns, then located, and then interpolated.  Tiles
+          are spread over get_thread_count() threads.
+          @param x          Points.  x[i][k] is component i of point k.
+          @param y          Results.  y[i][k] is set to component i of the value at point k (NaN for points outside the bounding box).
+          @param use_center Use center aware interpolation if true, and multilinear interpolation otherwise */
+      void interpolate_many(const drpt_batch_t& x, const rrpt_batch_t& y, bool use_center = true) const {
+        const std::size_t n         = x[0].size();
+        const std::size_t num_tiles = (n + interp_tile_size - 1) / interp_tile_size;
+        parallel_for(num_tiles, [this, &x, &y, n, use_center](std::size_t t) {
+                                  interpolate_tile(x, y, t*interp_tile_size, std::min(n, (t+1)*interp_tile_size), use_center);
+                                });
+      }
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Point Location & Interpolation Helpers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static std::size_t interp_tile_size = 256;  // Number of points handled together by interpolate_many()
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Interpolate the points with indexes in [first, last) for interpolate_many().  At most interp_tile_size points.  All points are quantized with
+         simple loops over the coordinate columns, then located, and then interpolated. */
+      void interpolate_tile(const drpt_batch_t& x, const rrpt_batch_t& y, std::size_t first, std::size_t last, bool use_center) const {
+        const std::size_t num = last - first;
+        std::array<diti_t, interp_tile_size> keys;
+        std::array<bool, interp_tile_size>   good;
+        keys.fill(0);
+        good.fill(true);
+        for(int i=0; i<dom_dim; i++)
+          for(std::size_t k=0; k<num; k++)
+            keys[k] = cuc_inc_crd(keys[k], i, drpt_crd_to_dic(x[i][first+k], i, good[k]));
+        for(std::size_t k=0; k<num; k++) {
+          diti_t leaf = (good[k] ? locate_leaf_diti(keys[k]) : 0);
+          rrta_t val;
+          if (leaf == 0) {
+            val.fill(std::numeric_limits<src_t>::quiet_NaN());
+          } else {
+            drpt_t xk;
+            if constexpr (dom_dim == 1)
+              xk = x[0][first+k];
+            else
+              for(int i=0; i<dom_dim; i++)
+                xk[i] = x[i][first+k];
+            val = interpolate_in_leaf(leaf, xk, use_center);
+          }
+          for(int i=0; i<rng_dim; i++)
+            y[i][first+k] = val[i];
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Integer coordinate of the minimum corner of the max_level cell holding a domain coordinate.  good is set to false if the coordinate is outside of
+         the bounding box by more than half a cell (or is NaN), and left alone otherwise. */
+      inline dic_t drpt_crd_to_dic(src_t x, int index, bool& good) const {
+        src_t t = (x - dom_at(bbox_min, index)) / dom_at(bbox_delta, index);
+        if ( !((t > static_cast<src_t>(-0.5)) && (t < static_cast<src_t>(dic_max) + static_cast<src_t>(0.5)))) {
+          good = false;
+          return 0;
+        }
+        return static_cast<dic_t>(std::clamp(t, static_cast<src_t>(0), static_cast<src_t>(dic_max - 1)));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** @overload */
+      inline dic_t drpt_crd_to_dic(drpt_t x, int index, bool& good) const requires (dom_dim > 1) { return drpt_crd_to_dic(x[index], index, good); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Find the leaf holding the max_level cell with minimum corner diti.  Binary search over levels -- existence of the cell holding diti is monotone in
+         level for a well formed tree. */
+      diti_t locate_leaf_diti(diti_t diti) const {
+        auto cell_at = [diti](int level) {
+          return static_cast<diti_t>((diti & level_cell_masks[level]) + diti_all_units * (static_cast<diti_t>(1) << (max_level-1-level)));
+        };
+        if ( !(vertex_exists(cell_at(0))))
+          return 0;
+        int lo = 0;
+        int hi = max_level - 1;
+        while (lo < hi) {
+          int mid = (lo + hi + 1) / 2;
+          if (vertex_exists(cell_at(mid)))
+            lo = mid;
+          else
+            hi = mid - 1;
+        }
+        return cell_at(lo);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Convert an rrta_t to an rrpt_t */
+      inline rrpt_t rrta_to_rrpt(const rrta_t& val) const {
+        if constexpr (rng_dim == 1)
+          return val[0];
+        else
+          return val;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /* Interpolate inside of a leaf cell. */
+      rrta_t interpolate_in_leaf(diti_t leaf, drpt_t domain_point, bool use_center) const {
+        const drpt_t ctr = diti_to_drpt(leaf);
+        const dic_t  hw  = ccc_cell_half_width(leaf);
+        std::array<src_t, dom_dim> t;  // Local coordinates in [-1, 1]
+        for(int i=0; i<dom_dim; i++)
+          t[i] = std::clamp((dom_at(domain_point, i) - dom_at(ctr, i)) / (dom_at(bbox_delta, i) * static_cast<src_t>(hw)), static_cast<src_t>(-1), static_cast<src_t>(1));
+        rrta_t rv;
+        rv.fill(static_cast<src_t>(0));
+        auto add_vertex = [this, &rv](diti_t vertex, src_t weight) {
+          rrta_t v = get_sample_rrta(vertex);
+          for(int j=0; j<rng_dim; j++)
+            rv[j] += weight * v[j];
+        };
+        const diti_corners_t corners = ccc_get_corners_array(leaf);
+        if ( !(use_center)) {
+          for(int c=0; c<(1 << dom_dim); c++) {
+            src_t w = 1;
+            for(int i=0; i<dom_dim; i++)
+              w *= (((c >> i) & 1) ? (1 + t[i]) : (1 - t[i])) / 2;
+            add_vertex(corners[c], w);
+          }
+          return rv;
+        }
+        int   face_axis = 0;  // Pyramid holding the point: face on face_axis in the direction of t[face_axis]
+        src_t s         = 0;  // Distance from the center to the point relative to the distance from the center to the face
+        for(int i=0; i<dom_dim; i++)
+          if (std::abs(t[i]) > s) {
+            s         = std::abs(t[i]);
+            face_axis = i;
+          }
+        add_vertex(leaf, 1 - s);
+        if (s > 0) {
+          const int face_dir = (t[face_axis] > 0 ? 1 : 0);
+          for(int c=0; c<(1 << dom_dim); c++) {
+            if (((c >> face_axis) & 1) != face_dir)
+              continue;
+            src_t w = s;
+            for(int i=0; i<dom_dim; i++)
+              if (i != face_axis)
+                w *= (((c >> i) & 1) ? (1 + t[i] / s) : (1 - t[i] / s)) / 2;
+            add_vertex(corners[c], w);
+          }
+        }
+        return rv;
+      }
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Dense Bricks
+
+          Uniformly refined regions may be moved out of the sample store into dense bricks.  A brick covers a cell at level brick_level, and holds all the
+          samples of that cell down to level brick_level+brick_depth in flat arrays.  A brick sample costs no key and no hash slot, and lookups are a little
+          integer arithmetic instead of a hash probe.  Samples finer than a brick, and samples outside of bricks, remain in the sample store.
+
+          Bricks are transparent -- vertex_exists(), get_sample(), sample iteration, etc... all work the same way with and without bricks. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Move samples of fully refined regions into dense bricks.
+          Any existing bricks are unpacked first.  Every cell at brick_level having all of its samples down to level brick_level+brick_depth is moved
+          into a brick.  A typical use is to call this after refine_grid().
+          @param new_brick_level Level of the cells covered by bricks.  Must be in [0, max_level-1].
+          @param new_brick_depth Number of levels below new_brick_level held in the brick.  new_brick_level+new_brick_depth must be in [0, max_level-1].
+          @return Number of bricks created.  Returns 0 on error. */
+      int pack_bricks(int new_brick_level, int new_brick_depth) {
+        unpack_bricks();
+        if ( (new_brick_level < 0) || (new_brick_depth < 0) || (new_brick_level + new_brick_depth > max_level-1) ) {
+          std::cout << "ERROR(pack_bricks): Invalid brick level or depth!" << std::endl;
+          return 0;
+        }
+        if (new_brick_level * dom_dim > 24) {
+          std::cout << "ERROR(pack_bricks): Brick directory too large!" << std::endl;
+          return 0;
+        }
+        const std::size_t nb   = static_cast<std::size_t>(1) << new_brick_level;
+        const dic_t       bwid = static_cast<dic_t>(dic_max >> new_brick_level);
+        std::size_t num_dir = 1;
+        for(int i=0; i<dom_dim; i++)
+          num_dir *= nb;
+        brick_level = new_brick_level;
+        brick_depth = new_brick_depth;
+        brick_ncrn  = 1;
+        std::size_t num_ctr = 1;
+        for(int i=0; i<dom_dim; i++) {
+          brick_ncrn *= brick_side();
+          num_ctr    *= brick_side() - 1;
+        }
+        brick_nslot = brick_ncrn + num_ctr;
+        brick_dir.assign(num_dir, -1);
+        const std::size_t nslot = brick_nslot;
+        std::vector<srpt_t> vals(nslot);
+        for(std::size_t dir_idx=0; dir_idx<num_dir; dir_idx++) {
+          diti_t origin = 0;
+          std::size_t tmp = dir_idx;
+          for(int i=0; i<dom_dim; i++) {
+            origin = cuc_inc_crd(origin, i, static_cast<dic_t>(static_cast<dic_t>(tmp % nb) * bwid));
+            tmp /= nb;
+          }
+          if ( !(sample_exists(cuc_inc_all_crd(origin, static_cast<dic_t>(bwid/2)))))
+            continue;
+          bool complete = true;
+          for(std::size_t local=0; local<nslot; local++) {
+            diti_t diti = brick_local_to_diti(origin, local);
+            if ( !(sample_exists(diti))) {
+              complete = false;
+              break;
+            }
+            vals[local] = sample_get(diti);
+          }
+          if ( !(complete))
+            continue;
+          for(std::size_t local=0; local<nslot; local++)
+            brick_sample_count += samples.erase(brick_local_to_diti(origin, local));
+          brick_dir[dir_idx] = static_cast<int32_t>(brick_origins.size());
+          brick_origins.push_back(origin);
+          brick_vals.insert(brick_vals.end(), vals.cbegin(), vals.cend());
+        }
+        if (brick_origins.empty()) {
+          brick_dir.clear();
+        } else {
+          brick_canon.resize(brick_vals.size());
+          for(std::size_t slot=0; slot<brick_vals.size(); slot++)
+            brick_canon[slot] = (brick_slot(brick_slot_to_diti(slot)) == slot);
+        }
+        return get_brick_count();
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Move all samples held in bricks back into the sample store, and remove all bricks. */
+      void unpack_bricks() {
+        if (brick_dir.empty())
+          return;
+        samples.reserve(samples.size() + brick_sample_count);
+        for_each_brick_sample([this](diti_t diti, const srpt_t& val) { samples.insert_or_assign(diti, val); });
+        brick_dir.clear();
+        brick_origins.clear();
+        brick_vals.clear();
+        brick_canon.clear();
+        brick_sample_count = 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of dense bricks. */
+      inline int get_brick_count() const { return static_cast<int>(brick_origins.size()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of samples held in dense bricks.  Note get_sample_count() includes these samples. */
+      inline std::size_t get_brick_sample_count() const { return brick_sample_count; }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Save & Load
+
+          save() writes the bounding box and every sample to a binary file which load() reads back exactly.  A tree may be refined once on a big machine,
+          and then the bridge & visualization steps run elsewhere without resampling.  Files are written & read with large sequential I/O.  The layout is
+          (all in native byte order):
+
+            - The 8 byte magic string "MRPTREE" (with the terminating NUL)
+            - Eight 32-bit integers: Format version, byte order mark (0x01020304), max_level, dom_dim, rng_dim, sizeof(src_t), sizeof(srt_t), & sizeof(diti_t)
+            - bbox_min & bbox_max (dom_dim src_t values each)
+            - The sample count, n, as a 64-bit integer
+            - n packed keys (diti_t) in increasing order
+            - Zero bytes padding to a multiple of alignof(srpt_t)
+            - n packed range values (srpt_t) -- in the same order as the keys
+
+          A file may be loaded by any tree with the same max_level, dimensions, & real types -- the sample store type need not match.  So a tree refined
+          with a hash store may be loaded directly into a ::frozen_t tree.  A ::view_t tree (see MR_rect_tree_view) does not read the file at all: load()
+          memory maps it, and queries read the keys & values directly from the mapped file. */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static uint32_t    save_version  = 1;          //!< Version of the save() file format
+      constexpr static char        save_magic[8] = "MRPTREE";  //!< Magic string starting save() files
+      constexpr static std::size_t save_chunk    = 1 << 16;    //!< Number of keys or values per read/write in save() & load()
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Header integers for save() files written by this tree type. */
+      constexpr static uint32_t save_header[8] = {save_version, 0x01020304, max_level, dom_dim, rng_dim, sizeof(src_t), sizeof(srt_t), sizeof(diti_t)};
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Size in bytes of a save() file header -- the keys start at this offset. */
+      constexpr static std::size_t save_header_size = sizeof(save_magic) + sizeof(save_header) + 2 * sizeof(drpt_t) + sizeof(uint64_t);
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Offset in bytes of the values in a save() file holding count samples. */
+      constexpr static std::size_t save_val_offset(std::size_t count) {
+        return (save_header_size + count * sizeof(diti_t) + alignof(srpt_t) - 1) / alignof(srpt_t) * alignof(srpt_t);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Save the tree to a binary file.  Samples held in dense bricks are saved as ordinary samples.
+          @param file_name Name of the file to write
+          @return 0 on success, and 1 on error */
+      int save(std::string file_name) const {
+        std::ofstream out_stream;
+        out_stream.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+        if ( !(out_stream.is_open())) {
+          std::cout << "ERROR(save): Could not open file!" << std::endl;
+          return 1;
+        }
+        const uint64_t count = get_sample_count();
+        out_stream.write(save_magic,                                 sizeof(save_magic));
+        out_stream.write(reinterpret_cast<const char*>(save_header), sizeof(save_header));
+        out_stream.write(reinterpret_cast<const char*>(&bbox_min),   sizeof(drpt_t));
+        out_stream.write(reinterpret_cast<const char*>(&bbox_max),   sizeof(drpt_t));
+        out_stream.write(reinterpret_cast<const char*>(&count),      sizeof(uint64_t));
+        std::vector<std::pair<diti_t, srpt_t>> elts(cbegin_samples(), cend_samples());
+        std::sort(elts.begin(), elts.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+        auto write_column = [&out_stream, &elts](auto get_elt) {
+          std::vector<decltype(get_elt(elts[0]))> buf;
+          buf.reserve(save_chunk);
+          for(std::size_t start=0; start<elts.size(); start+=save_chunk) {
+            buf.clear();
+            for(std::size_t k=start; k<std::min(start+save_chunk, elts.size()); k++)
+              buf.push_back(get_elt(elts[k]));
+            out_stream.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(buf.size() * sizeof(buf[0])));
+          }
+        };
+        write_column([](const std::pair<diti_t, srpt_t>& kvp) { return kvp.first;  });
+        const char pad[alignof(srpt_t)] = {};
+        out_stream.write(pad, static_cast<std::streamsize>(save_val_offset(count) - save_header_size - count * sizeof(diti_t)));
+        write_column([](const std::pair<diti_t, srpt_t>& kvp) { return kvp.second; });
+        out_stream.close();
+        if (out_stream.fail()) {
+          std::cout << "ERROR(save): Write failed!" << std::endl;
+          return 1;
+        }
+        return 0;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Replace the contents of the tree (bounding box, samples, & bricks) with a file written by save().
+          The tree is not modified if the file can not be opened, is not a save() file, or was saved by a different tree type.  If reading the samples
+          fails part way through, then the tree is left with no samples.  Any open journal is closed.  A ::view_t tree maps the file instead of reading it
+          (the tree is not modified if the map fails), and the file must not be modified while the tree is in use.
+          @param file_name Name of the file to read
+          @return 0 on success, and 1 on error */
+      int load(std::string file_name) {
+        std::ifstream key_stream(file_name, std::ios::in | std::ios::binary);
+        std::ifstream val_stream(file_name, std::ios::in | std::ios::binary);
+        if ( !(key_stream.is_open() && val_stream.is_open())) {
+          std::cout << "ERROR(load): Could not open file!" << std::endl;
+          return 1;
+        }
+        char     magic[sizeof(save_magic)];
+        uint32_t header[8];
+        drpt_t   new_bbox_min, new_bbox_max;
+        uint64_t count = 0;
+        key_stream.read(magic,                                      sizeof(magic));
+        key_stream.read(reinterpret_cast<char*>(header),            sizeof(header));
+        key_stream.read(reinterpret_cast<char*>(&new_bbox_min),     sizeof(drpt_t));
+        key_stream.read(reinterpret_cast<char*>(&new_bbox_max),     sizeof(drpt_t));
+        key_stream.read(reinterpret_cast<char*>(&count),            sizeof(uint64_t));
+        if (key_stream.fail() || (std::memcmp(magic, save_magic, sizeof(magic)) != 0)) {
+          std::cout << "ERROR(load): Not a tree file!" << std::endl;
+          return 1;
+        }
+        if (header[0] != save_version) {
+          std::cout << "ERROR(load): Unsupported file version!" << std::endl;
+          return 1;
+        }
+        if ( !(std::equal(std::begin(header), std::end(header), std::begin(save_header)))) {
+          std::cout << "ERROR(load): File was saved by a different tree type!" << std::endl;
+          return 1;
+        }
+        for(int i=0; i<dom_dim; i++) {
+          if ( !(dom_at(new_bbox_min, i) < dom_at(new_bbox_max, i))) {
+            std::cout << "ERROR(load): Invalid bounding box!" << std::endl;
+            return 1;
+          }
+        }
+        std::error_code ec;
+        const std::uintmax_t file_size = std::filesystem::file_size(file_name, ec);
+        if (ec || (file_size < save_header_size) || (count > (file_size - save_header_size) / (sizeof(diti_t) + sizeof(srpt_t))) ||
+            (file_size < save_val_offset(count) + count * sizeof(srpt_t))) {
+          std::cout << "ERROR(load): File is truncated!" << std::endl;
+          return 1;
+        }
+        auto reset_state = [this, &new_bbox_min, &new_bbox_max]() {
+          close_journal();
+          brick_dir.clear();
+          brick_origins.clear();
+          brick_vals.clear();
+          brick_canon.clear();
+          brick_sample_count = 0;
+          leaf_index_invalidate();
+          set_bbox(new_bbox_min, new_bbox_max);
+        };
+        if constexpr (requires { samples.map_file(file_name, save_header_size, save_val_offset(count), count); }) {
+          sample_store_t new_samples;
+          if (new_samples.map_file(file_name, save_header_size, save_val_offset(count), static_cast<std::size_t>(count))) {
+            std::cout << "ERROR(load): Could not map file!" << std::endl;
+            return 1;
+          }
+          reset_state();
+          samples = std::move(new_samples);
+          return 0;
+        } else {
+          reset_state();
+          val_stream.seekg(static_cast<std::streamoff>(save_val_offset(count)));
+          std::vector<diti_t> keys;
+          std::vector<srpt_t> vals;
+          std::vector<std::pair<diti_t, srpt_t>> elts;  // Only used by stores without insert_or_assign()
+          constexpr bool insertable = requires { samples.insert_or_assign(diti_t(), srpt_t()); };
+          if constexpr (insertable) {
+            samples.clear();
+            samples.reserve(count);
+          } else {
+            elts.reserve(count);
+          }
+          for(uint64_t start=0; start<count; start+=save_chunk) {
+            const std::size_t num = static_cast<std::size_t>(std::min<uint64_t>(save_chunk, count - start));
+            keys.resize(num);
+            vals.resize(num);
+            key_stream.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(num * sizeof(diti_t)));
+            val_stream.read(reinterpret_cast<char*>(vals.data()), static_cast<std::streamsize>(num * sizeof(srpt_t)));
+            if (key_stream.fail() || val_stream.fail())
+              break;
+            for(std::size_t k=0; k<num; k++) {
+              if constexpr (insertable)
+                samples.insert_or_assign(keys[k], vals[k]);
+              else
+                elts.emplace_back(keys[k], vals[k]);
+            }
+          }
+          if constexpr ( !(insertable))
+            samples = sample_store_t(elts.cbegin(), elts.cend());
+          if (key_stream.fail() || val_stream.fail()) {
+            samples = sample_store_t();
+            std::cout << "ERROR(load): Read failed!" << std::endl;
+            return 1;
+          }
+          return 0;
+        }
+      }
+      //@}
+
       //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
       /** @name Debug */
       //@{
@@ -1557,13 +4230,14 @@ namespace mjr {
         std::cout << "  max_level ...... " << max_level << std::endl;
         std::cout << "  size icrd Cmp .. " << sizeof(dic_t)  << std::endl;
         std::cout << "  size icrd Tup .. " << sizeof(diti_t) << std::endl;
-        std::cout << "  Samples ........ " << samples.size() << std::endl;
+        std::cout << "  Samples ........ " << get_sample_count() << std::endl;
         std::cout << "  Leaf Cells ..... " << count_leaf_cells(ccc_get_top_cell()) << std::endl;
         std::cout << "Samples" << std::endl;
         int num_printed = 0;
-        for (const auto& kvp : samples) {
+        for(auto kvp_itr=cbegin_samples(); kvp_itr!=cend_samples(); ++kvp_itr) {
+          auto kvp = *kvp_itr;
           std::cout << "  c=" << diti_to_string(kvp.first, true);
-          std::cout << " v=" << rrpt_to_string(kvp.second) << std::endl;
+          std::cout << " v=" << rrpt_to_string(srpt_to_rrpt(kvp.second)) << std::endl;
           num_printed++;
           if ((max_num_print > 0) && (num_printed >= max_num_print)) {
             std::cout << "Maximum number of samples reached.  Halting tree dump." << std::endl;
@@ -1572,6 +4246,55 @@ namespace mjr {
         }
       }
       //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Histogram describing how samples are distributed in the sample store.
+          - For stores providing probe_length_counts() (MR_flat_map): element i is the number of samples stored i slots past their home slot.
+          - For stores with a bucket interface (std::unordered_map): element i is the number of buckets holding i samples.
+          - For other stores (MR_sorted_map) the histogram is empty.
+          @return The histogram.  Trailing zero counts are not included. */
+      std::vector<std::size_t> sample_store_histogram() const {
+        if constexpr (requires { samples.probe_length_counts(); }) {
+          return samples.probe_length_counts();
+        } else if constexpr ( !(requires { samples.bucket_size(0); })) {
+          return std::vector<std::size_t>();
+        } else {
+          std::vector<std::size_t> counts;
+          for(std::size_t i=0; i<samples.bucket_count(); i++) {
+            std::size_t n = samples.bucket_size(i);
+            if (counts.size() <= n)
+              counts.resize(n+1, 0);
+            counts[n]++;
+          }
+          return counts;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Dump sample store distribution statistics to STDOUT.
+          For open addressing stores we print a probe length histogram and the mean probe length (zero is ideal).  For bucket based stores we print a bucket
+          occupancy histogram and the mean number of samples in a bucket, counted from the point of view of a sample (one is ideal). */
+      void dump_sample_store_stats() const {
+        constexpr bool probe_hist = requires { samples.probe_length_counts(); };
+        std::vector<std::size_t> counts = sample_store_histogram();
+        std::cout << "Sample Store" << std::endl;
+        std::cout << "  Samples ........ " << samples.size() << std::endl;
+        std::cout << "  Buckets ........ " << samples.bucket_count() << std::endl;
+        std::cout << "  Load Factor .... " << samples.load_factor() << std::endl;
+        if ( !(brick_dir.empty())) {
+          std::cout << "  Bricks ......... " << get_brick_count() << std::endl;
+          std::cout << "  Brick Samples .. " << brick_sample_count << std::endl;
+        }
+        if (counts.empty())
+          return;
+        double weighted_sum = 0;
+        for(std::size_t i=0; i<counts.size(); i++)
+          weighted_sum += static_cast<double>(counts[i]) * static_cast<double>(i) * (probe_hist ? 1.0 : static_cast<double>(i));
+        if (samples.size() > 0)
+          std::cout << (probe_hist ? "  Mean Probe ..... " : "  Mean Bucket .... ") << weighted_sum / static_cast<double>(samples.size()) << std::endl;
+        std::cout << (probe_hist ? "Probe Length Histogram" : "Bucket Occupancy Histogram") << std::endl;
+        for(std::size_t i=0; i<counts.size(); i++)
+          if (counts[i] > 0)
+            std::cout << "  " << std::setw(4) << i << " " << counts[i] << std::endl;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
       /** Dump tree points to file -- one tuple per line with domain coordinates followed by range values. */
       int dump_tree_datafile(std::string file_name) const {
         std::ofstream out_stream;
@@ -1582,11 +4305,12 @@ namespace mjr {
           std::cout << "ERROR(write_xml_vtk): Could not open file!" << std::endl;
           return 1;
         }
-        for (const auto& kvp : samples) {
+        for(auto kvp_itr=cbegin_samples(); kvp_itr!=cend_samples(); ++kvp_itr) {
+          auto kvp = *kvp_itr;
           for(int i=0; i<dom_dim; i++)
             out_stream << std::setprecision(5) << dom_at(diti_to_drpt(kvp.first), i) << " ";
           for(int i=0; i<rng_dim; i++)
-            out_stream << std::setprecision(5) << rng_at(kvp.second, i) << " ";
+            out_stream << std::setprecision(5) << rng_at(srpt_to_rrpt(kvp.second), i) << " ";
           out_stream << std::endl;
         }
         out_stream.close();
@@ -1597,6 +4321,25 @@ namespace mjr {
 
   };
 
+    //--------------------------------------------------------------------------------------------------------------------------------------------------------
+    /** Read only view of a file written by MR_rect_tree::save().
+
+        load() memory maps the file instead of reading it, so even multi-gigabyte trees open in milliseconds, only the pages touched by queries are read,
+        and processes viewing the same file share one copy in the page cache.  A view supports the entire const query API (like a frozen tree), and may be
+        used with MR_rt_to_cc.  Views require MR_mapped_map.hpp, which MR_rect_tree.hpp does not include.  Example:
+
+        @code
+        #include "MR_rect_tree.hpp"
+        #include "MR_mapped_map.hpp"
+        mjr::MR_rect_tree_view<15, double, 2, 1> view;
+        if (view.load("surface.mrpt") == 0)
+          auto leaves = view.get_leaf_cells();
+        @endcode
+
+        This is the same type as MR_rect_tree::view_t. */
+    template <int max_level, class spc_real_t, int dom_dim, int rng_dim, class rng_store_real_t = spc_real_t>
+    using MR_rect_tree_view = MR_rect_tree<max_level, spc_real_t, dom_dim, rng_dim, MR_mapped_map, rng_store_real_t>;
+
     //--------------------------------------------------------------------------------------------------------------------------------------------------------
     /* 7-bit per coordinate */
     typedef mjr::MR_rect_tree<7, double, 1, 1> tree7b1d1rT;
@@ -1728,6 +4471,20 @@ namespace mjr {
     typedef mjr::MR_rect_tree<63, double, 1, 2> tree63b1d2rT;
     typedef mjr::MR_rect_tree<63, double, 1, 3> tree63b1d3rT;
     typedef mjr::MR_rect_tree<63, double, 1, 4> tree63b1d4rT;
+
+    //--------------------------------------------------------------------------------------------------------------------------------------------------------
+    /* 15-bit per coordinate with double domain & float range storage */
+    typedef mjr::MR_rect_tree<15, double, 1, 1,  MR_flat_map, float> tree15b1d1rfT;
+    typedef mjr::MR_rect_tree<15, double, 2, 1,  MR_flat_map, float> tree15b2d1rfT;
+    typedef mjr::MR_rect_tree<15, double, 3, 1,  MR_flat_map, float> tree15b3d1rfT;
+
+    typedef mjr::MR_rect_tree<15, double, 1, 3,  MR_flat_map, float> tree15b1d3rfT;
+    typedef mjr::MR_rect_tree<15, double, 2, 3,  MR_flat_map, float> tree15b2d3rfT;
+    typedef mjr::MR_rect_tree<15, double, 3, 3,  MR_flat_map, float> tree15b3d3rfT;
+
+    typedef mjr::MR_rect_tree<15, double, 1, 15, MR_flat_map, float> tree15b1d15rfT;
+    typedef mjr::MR_rect_tree<15, double, 2, 15, MR_flat_map, float> tree15b2d15rfT;
+    typedef mjr::MR_rect_tree<15, double, 3, 15, MR_flat_map, float> tree15b3d15rfT;
 }
 
 #define MJR_INCLUDE_MR_rect_tree
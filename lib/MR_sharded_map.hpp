@@ -0,0 +1,344 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_sharded_map.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_sharded_map class.@EOL
+ @keywords  hash table concurrent sharded mutex
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_sharded_map
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <array>                                                         /* array template          C++11    */
+#include <condition_variable>                                            /* Condition variables     C++11    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iterator>                                                      /* STL Iterators           C++11    */
+#include <mutex>                                                         /* Mutexes                 C++11    */
+#include <stdexcept>                                                     /* Exceptions              C++11    */
+#include <utility>                                                       /* STL Misc Utilities      C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_flat_map.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Concurrent hash map for use as an MR_rect_tree sample store when several threads refine one tree.
+
+      The map is split into a fixed number of shards, each an MR_flat_map protected by its own mutex.  The shard for a key is picked by the low bits of
+      the hash (MR_flat_map uses the high bits of a multiplied hash for its home slot, so the two choices are independent).  Threads working on different
+      parts of a tree rarely touch the same shard at the same time.
+
+      The important addition over the MR_flat_map interface is try_emplace_with().  It inserts a value computed by a function only if the key is absent,
+      and it guarantees the function is called at most once per key even when several threads ask for the same key at the same time -- the later
+      threads wait for the first one to finish.  MR_rect_tree uses it to sample vertexes shared by neighboring cells exactly once during concurrent
+      refinement (see MR_rect_tree::refine_recursive_cell_pred_parallel()).
+
+      contains(), at(), count(), insert_or_assign(), try_emplace_with(), & erase() are safe to call concurrently.  at() returns by value.  Everything else
+      (iteration, reserve(), clear(), size(), etc...) must not overlap with modifications.
+
+      @tparam key_t  The key type
+      @tparam val_t  The mapped type
+      @tparam hash_t The hash function object type */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_sharded_map {
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef key_t                     key_type;         //!< Key type
+      typedef val_t                     mapped_type;      //!< Mapped type
+      typedef std::pair<key_t, val_t>   value_type;       //!< Element type
+      typedef hash_t                    hasher;           //!< Hash function type
+      typedef std::size_t               size_type;        //!< Size type
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static int num_shards = 64;               //!< Number of shards.  Must be a power of two.
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Shards */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef MR_flat_map<key_t, val_t, hash_t> shard_map_t;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      struct shard_t {
+        mutable std::mutex                    mtx;      //!< Guards everything in the shard
+        std::condition_variable               done;     //!< Signaled when a pending key is stored
+        shard_map_t                           map;      //!< Key/value storage
+        MR_flat_map<key_t, uint8_t, hash_t>   pending;  //!< Keys being computed by try_emplace_with()
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::array<shard_t, num_shards> shards;
+      hasher                          hash_func;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline shard_t&       shard_of(const key_t& key)       { return shards[static_cast<uint64_t>(hash_func(key)) & (num_shards - 1)]; }
+      inline const shard_t& shard_of(const key_t& key) const { return shards[static_cast<uint64_t>(hash_func(key)) & (num_shards - 1)]; }
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @brief Constant forward iterator for MR_sharded_map.  Elements are visited shard by shard. */
+      class const_iterator {
+        public:
+          typedef std::forward_iterator_tag iterator_category;
+          typedef MR_sharded_map::value_type value_type;
+          typedef std::ptrdiff_t             difference_type;
+          typedef const value_type*          pointer;
+          typedef const value_type&          reference;
+          const_iterator() = default;
+          const_iterator(const MR_sharded_map* new_map, int new_shard) : map(new_map), shard(new_shard) {
+            if (shard < num_shards)
+              itr = map->shards[shard].map.cbegin();
+            skip_empty();
+          }
+          reference       operator*()  const { return *itr;  }
+          pointer         operator->() const { return &(*itr); }
+          const_iterator& operator++()       { ++itr; skip_empty(); return *this; }
+          const_iterator  operator++(int)    { const_iterator tmp = *this; ++(*this); return tmp; }
+          bool operator==(const const_iterator& other) const { return ((shard == other.shard) && ((shard >= num_shards) || (itr == other.itr))); }
+        private:
+          void skip_empty() {
+            while ((shard < num_shards) && (itr == map->shards[shard].map.cend()))
+              if (++shard < num_shards)
+                itr = map->shards[shard].map.cbegin();
+          }
+          const MR_sharded_map*                 map   = nullptr;
+          int                                   shard = num_shards;
+          typename shard_map_t::const_iterator  itr;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The iterator type.  Elements may not be modified via iterators, so this is the same as const_iterator. */
+      typedef const_iterator iterator;
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct an empty map.  No storage is allocated until the first insert. */
+      MR_sharded_map() = default;
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Copy the elements of another map.  Must not overlap with modifications of other. */
+      MR_sharded_map(const MR_sharded_map& other) { *this = other; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Move the elements of another map.  Must not overlap with modifications of other. */
+      MR_sharded_map(MR_sharded_map&& other) { *this = std::move(other); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Copy the elements of another map.  Must not overlap with modifications of either map. */
+      MR_sharded_map& operator=(const MR_sharded_map& other) {
+        for(int i=0; i<num_shards; i++)
+          shards[i].map = other.shards[i].map;
+        return *this;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Move the elements of another map.  Must not overlap with modifications of either map. */
+      MR_sharded_map& operator=(MR_sharded_map&& other) {
+        for(int i=0; i<num_shards; i++)
+          shards[i].map = std::move(other.shards[i].map);
+        return *this;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Capacity */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements in the map */
+      size_type size() const {
+        size_type n = 0;
+        for(auto& s: shards)
+          n += s.map.size();
+        return n;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if the map holds no elements */
+      inline bool empty() const { return (size() == 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of slots in all shards */
+      size_type bucket_count() const {
+        size_type n = 0;
+        for(auto& s: shards)
+          n += s.map.bucket_count();
+        return n;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Current load factor over all shards */
+      inline float load_factor() const {
+        size_type n = bucket_count();
+        return (n == 0 ? 0.0f : static_cast<float>(size()) / static_cast<float>(n));
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Grow the shards so that at least count elements may be held without a rehash -- assuming keys are spread evenly (with 1/8 slack).
+          @param count Number of elements */
+      void reserve(size_type count) {
+        size_type per_shard = count / num_shards;
+        per_shard += per_shard / 8 + 1;
+        for(auto& s: shards)
+          s.map.reserve(per_shard);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Histogram of probe lengths summed over all shards.  See MR_flat_map::probe_length_counts(). */
+      std::vector<size_type> probe_length_counts() const {
+        std::vector<size_type> counts;
+        for(auto& s: shards) {
+          std::vector<size_type> shard_counts = s.map.probe_length_counts();
+          if (counts.size() < shard_counts.size())
+            counts.resize(shard_counts.size(), 0);
+          for(size_type i=0; i<shard_counts.size(); i++)
+            counts[i] += shard_counts[i];
+        }
+        return counts;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove all elements and release storage */
+      void clear() {
+        for(auto& s: shards)
+          s.map.clear();
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Lookup */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if key is in the map.  Keys still being computed by try_emplace_with() are not in the map.
+          @param key Key to search for */
+      inline bool contains(const key_t& key) const {
+        const shard_t& s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return s.map.contains(key);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Return 1 if key is in the map, and 0 otherwise.
+          @param key Key to search for */
+      inline size_type count(const key_t& key) const { return (contains(key) ? 1 : 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element with bounds checking.
+          @param key Key to search for
+          @return Copy of the mapped value
+          @throws std::out_of_range if key is not in the map */
+      inline val_t at(const key_t& key) const {
+        const shard_t& s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return s.map.at(key);
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Modifiers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Insert an element, or replace the value if the key is already in the map.
+          @param key   Key to insert
+          @param value Value to insert
+          @return A pair with a copy of the element and true if a new element was inserted.  Like at(), the element is returned by value because it can
+                  not be referenced once the shard lock is released. */
+      std::pair<value_type, bool> insert_or_assign(const key_t& key, const val_t& value) {
+        shard_t& s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return {value_type(key, value), s.map.insert_or_assign(key, value).second};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Insert make() for key if key is not in the map.
+
+          make is called at most once per key.  If another thread is already computing the value for key, then this call waits for it to finish and returns
+          the stored value.  make is called without holding any lock, so it may take as long as it likes.  If make throws, then the key is released (another
+          thread may then compute it) and the exception is propagated.
+
+          @param key  Key to insert
+          @param make Function returning the value for key
+          @return A pair with the value for key, and true if this call computed it */
+      template <class make_t>
+      std::pair<val_t, bool> try_emplace_with(const key_t& key, make_t&& make) {
+        shard_t& s = shard_of(key);
+        {
+          std::unique_lock<std::mutex> lock(s.mtx);
+          while (true) {
+            auto itr = s.map.find(key);
+            if (itr != s.map.cend())
+              return {itr->second, false};
+            if ( !(s.pending.contains(key)))
+              break;
+            s.done.wait(lock);
+          }
+          s.pending.insert_or_assign(key, 1);
+        }
+        val_t value;
+        try {
+          value = make();
+        } catch (...) {
+          {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            s.pending.erase(key);
+          }
+          s.done.notify_all();
+          throw;
+        }
+        {
+          std::lock_guard<std::mutex> lock(s.mtx);
+          s.map.insert_or_assign(key, value);
+          s.pending.erase(key);
+        }
+        s.done.notify_all();
+        return {value, true};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove an element.
+          @param key Key to remove
+          @return Number of elements removed (0 or 1) */
+      size_type erase(const key_t& key) {
+        shard_t& s = shard_of(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return s.map.erase(key);
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Iterators */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline const_iterator cbegin() const { return const_iterator(this, 0);          } //!< Iterator to first element
+      inline const_iterator cend()   const { return const_iterator(this, num_shards); } //!< Iterator past the last element
+      inline const_iterator begin()  const { return cbegin();                         } //!< Iterator to first element
+      inline const_iterator end()    const { return cend();                           } //!< Iterator past the last element
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_sharded_map
+#endif
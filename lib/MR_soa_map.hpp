@@ -0,0 +1,324 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_soa_map.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_soa_map class.@EOL
+ @keywords  hash table structure of arrays SoA column store
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_soa_map
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <array>                                                         /* array template          C++11    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iterator>                                                      /* STL Iterators           C++11    */
+#include <span>                                                          /* STL spans               C++20    */
+#include <stdexcept>                                                     /* Exceptions              C++11    */
+#include <type_traits>                                                   /* C++ metaprogramming     C++11    */
+#include <utility>                                                       /* STL Misc Utilities      C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "MR_flat_map.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Structure of arrays (SoA) map for use as an MR_rect_tree sample store.
+
+      Values are either an arithmetic type or an std::array of an arithmetic type.  Instead of storing each value as a record next to its key, this map
+      stores one contiguous column per value component.  A compact MR_flat_map maps each key to a row index into the columns, and the keys are also kept
+      in a column of their own.  Rows are kept packed -- erase() moves the last row into the hole.
+
+      The point is to make single component operations cheap.  Code that only looks at one component of a value (a level crossing test, a min/max scan,
+      etc...) can use component_at() or column() and never touch the other components.  Whole column scans are simple loops over a contiguous array that
+      the compiler can vectorize.  The price is that at() must gather a value from several columns, and so returns by value.
+
+      The interface is the subset of std::unordered_map used by MR_rect_tree plus component_at(), column(), & key_column().  Iteration is in row order, and
+      iterators dereference to a `std::pair<key_t, val_t>` by value.
+
+      @warning Spans returned by column() & key_column() are invalidated by any insertion, and by erase().
+
+      @tparam key_t  The key type
+      @tparam val_t  The mapped type -- arithmetic, or an std::array of arithmetic
+      @tparam hash_t The hash function object type */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_soa_map {
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Value Decomposition */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      template <class T>           struct val_traits                  { typedef T scl_t; constexpr static int num_cmp = 1; };
+      template <class T, size_t N> struct val_traits<std::array<T, N>> { typedef T scl_t; constexpr static int num_cmp = static_cast<int>(N); };
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef key_t                                  key_type;         //!< Key type
+      typedef val_t                                  mapped_type;      //!< Mapped type
+      typedef std::pair<key_t, val_t>                value_type;       //!< Element type (returned by value)
+      typedef hash_t                                 hasher;           //!< Hash function type
+      typedef std::size_t                            size_type;        //!< Size type
+      typedef typename val_traits<val_t>::scl_t      scalar_type;      //!< Type of a single value component
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static int num_components = val_traits<val_t>::num_cmp;  //!< Number of columns
+      //@}
+
+      static_assert(std::is_arithmetic<scalar_type>::value, "MR_soa_map: val_t must be arithmetic or an std::array of arithmetic");
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      MR_flat_map<key_t, size_type, hash_t>                    rows;      //!< Key to row index
+      std::vector<key_t>                                       keys;      //!< Key for each row
+      std::array<std::vector<scalar_type>, num_components>     columns;   //!< One column per value component
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @brief Constant forward iterator for MR_soa_map.  Elements are visited in row order, and are returned by value. */
+      class const_iterator {
+        public:
+          /** Holds an element so that operator->() has something to point at. */
+          struct arrow_proxy {
+            value_type elt;
+            const value_type* operator->() const { return &elt; }
+          };
+          typedef std::forward_iterator_tag iterator_category;
+          typedef MR_soa_map::value_type    value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef arrow_proxy               pointer;
+          typedef value_type                reference;
+          const_iterator() = default;
+          const_iterator(const MR_soa_map* new_map, size_type new_row) : map(new_map), row(new_row) { }
+          reference       operator*()  const { return value_type(map->keys[row], map->get_row(row)); }
+          pointer         operator->() const { return arrow_proxy{**this}; }
+          const_iterator& operator++()       { row++; return *this; }
+          const_iterator  operator++(int)    { const_iterator tmp = *this; ++(*this); return tmp; }
+          bool operator==(const const_iterator& other) const { return (row == other.row); }
+        private:
+          const MR_soa_map* map = nullptr;
+          size_type         row = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The iterator type.  Elements may not be modified via iterators, so this is the same as const_iterator. */
+      typedef const_iterator iterator;
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct an empty map.  No storage is allocated until the first insert. */
+      MR_soa_map() = default;
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Capacity */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements in the map */
+      inline size_type size() const { return keys.size(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if the map holds no elements */
+      inline bool empty() const { return keys.empty(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of slots in the key index */
+      inline size_type bucket_count() const { return rows.bucket_count(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Current load factor of the key index */
+      inline float load_factor() const { return rows.load_factor(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Reserve space for count elements in the key index and in every column.
+          @param count Number of elements */
+      void reserve(size_type count) {
+        rows.reserve(count);
+        keys.reserve(count);
+        for(auto& c: columns)
+          c.reserve(count);
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Histogram of probe lengths in the key index.  See MR_flat_map::probe_length_counts(). */
+      inline std::vector<size_type> probe_length_counts() const { return rows.probe_length_counts(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove all elements and release storage */
+      void clear() {
+        rows.clear();
+        keys.clear();
+        keys.shrink_to_fit();
+        for(auto& c: columns) {
+          c.clear();
+          c.shrink_to_fit();
+        }
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Lookup */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if key is in the map
+          @param key Key to search for */
+      inline bool contains(const key_t& key) const { return rows.contains(key); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements with the given key (0 or 1)
+          @param key Key to search for */
+      inline size_type count(const key_t& key) const { return (contains(key) ? 1 : 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element with bounds checking.  The value is gathered from the columns, and returned by value.
+          @param key Key to search for
+          @return The mapped value
+          @throws std::out_of_range if key is not in the map */
+      inline val_t at(const key_t& key) const { return get_row(row_of(key)); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access a single component of an element with bounds checking.  Only the requested column is touched.
+          @param key   Key to search for
+          @param index Component index
+          @return The component value
+          @throws std::out_of_range if key is not in the map */
+      inline scalar_type component_at(const key_t& key, int index) const { return columns[index][row_of(key)]; }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Contiguous view of one value component for all elements in row order.
+          @param index Component index */
+      inline std::span<const scalar_type> column(int index) const { return std::span<const scalar_type>(columns[index]); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Contiguous view of the keys for all elements in row order. */
+      inline std::span<const key_t> key_column() const { return std::span<const key_t>(keys); }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Modifiers */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Insert an element, or replace the value if the key is already in the map.
+          @param key   Key to insert
+          @param value Value to insert
+          @return A pair with an iterator to the element and true if a new element was inserted */
+      std::pair<const_iterator, bool> insert_or_assign(const key_t& key, const val_t& value) {
+        auto itr = rows.find(key);
+        if (itr != rows.cend()) {
+          set_row(itr->second, value);
+          return {const_iterator(this, itr->second), false};
+        }
+        size_type row = keys.size();
+        rows.insert_or_assign(key, row);
+        keys.push_back(key);
+        for(auto& c: columns)
+          c.emplace_back();
+        set_row(row, value);
+        return {const_iterator(this, row), true};
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Remove an element.  The last row is moved into the vacated row.
+          @param key Key to remove
+          @return Number of elements removed (0 or 1) */
+      size_type erase(const key_t& key) {
+        if ( !(rows.contains(key)))
+          return 0;
+        size_type row  = rows.at(key);
+        size_type last = keys.size() - 1;
+        if (row != last) {
+          keys[row] = keys[last];
+          for(auto& c: columns)
+            c[row] = c[last];
+          rows.at(keys[row]) = row;
+        }
+        keys.pop_back();
+        for(auto& c: columns)
+          c.pop_back();
+        rows.erase(key);
+        return 1;
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Iterators */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline const_iterator cbegin() const { return const_iterator(this, 0);           } //!< Iterator to first element
+      inline const_iterator cend()   const { return const_iterator(this, keys.size()); } //!< Iterator past the last element
+      inline const_iterator begin()  const { return cbegin();                          } //!< Iterator to first element
+      inline const_iterator end()    const { return cend();                            } //!< Iterator past the last element
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Row Mechanics */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Row index for key.
+          @throws std::out_of_range if key is not in the map */
+      inline size_type row_of(const key_t& key) const {
+        auto itr = rows.find(key);
+        if (itr == rows.cend())
+          throw std::out_of_range("MR_soa_map::at");
+        return itr->second;
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Gather a value from the columns */
+      inline val_t get_row(size_type row) const {
+        if constexpr (std::is_arithmetic<val_t>::value) {
+          return columns[0][row];
+        } else {
+          val_t ret;
+          for(int i=0; i<num_components; i++)
+            ret[i] = columns[i][row];
+          return ret;
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Scatter a value into the columns */
+      inline void set_row(size_type row, const val_t& value) {
+        if constexpr (std::is_arithmetic<val_t>::value) {
+          columns[0][row] = value;
+        } else {
+          for(int i=0; i<num_components; i++)
+            columns[i][row] = value[i];
+        }
+      }
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_soa_map
+#endif
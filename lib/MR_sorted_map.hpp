@@ -0,0 +1,284 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      MR_sorted_map.hpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Implimentation of the MR_sorted_map class.@EOL
+ @keywords  sorted array map binary search immutable
+ @std       C++23
+ @see       MR_rect_tree.hpp
+ @copyright
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifndef MJR_INCLUDE_MR_sorted_map
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include <algorithm>                                                     /* STL algorithm           C++11    */
+#include <bit>                                                           /* STL bit manipulation    C++20    */
+#include <cstdint>                                                       /* std:: C stdint.h        C++11    */
+#include <functional>                                                    /* STL funcs               C++98    */
+#include <iterator>                                                      /* STL Iterators           C++11    */
+#include <numeric>                                                       /* C++ numeric             C++11    */
+#include <stdexcept>                                                     /* Exceptions              C++11    */
+#include <type_traits>                                                   /* C++ metaprogramming     C++11    */
+#include <utility>                                                       /* STL Misc Utilities      C++11    */
+#include <vector>                                                        /* STL vector              C++11    */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Put everything in the mjr namespace
+namespace mjr {
+  /** @brief Immutable sorted array map used as the sample store for frozen MR_rect_tree objects (see MR_rect_tree::freeze()).
+
+      Keys are held in one sorted array, and values are held in a second array in the same order.  There are no empty slots and no per element overhead, so
+      memory use is just the size of the keys and values.  Lookups narrow the search range with a small index on the high bits of the key, then with an
+      interpolation guess, and finish with a branch free binary search over the remaining keys.
+
+      The map is built once from a range of key/value pairs, and can not be modified.  In particular it has no insert_or_assign() -- so an MR_rect_tree
+      using this store will fail to compile if any method that adds samples is used.
+
+      The interface is the read only subset of std::unordered_map used by MR_rect_tree.  Iteration is in increasing key order, and iterators dereference to a
+      `std::pair<key_t, val_t>` by value.
+
+      @tparam key_t  The key type -- must be an unsigned integer type
+      @tparam val_t  The mapped type
+      @tparam hash_t Ignored.  Present so that this template may be used as an MR_rect_tree store_t */
+  template <class key_t, class val_t, class hash_t = std::hash<key_t>>
+  class MR_sorted_map {
+
+    static_assert(std::is_unsigned<key_t>::value, "MR_sorted_map: key_t must be an unsigned integer type");
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Container Types */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      typedef key_t                     key_type;         //!< Key type
+      typedef val_t                     mapped_type;      //!< Mapped type
+      typedef std::pair<key_t, val_t>   value_type;       //!< Element type (returned by value)
+      typedef std::size_t               size_type;        //!< Size type
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Data Members */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      std::vector<key_t>     keys;            //!< Sorted keys
+      std::vector<val_t>     vals;            //!< Values in the same order as keys
+      std::vector<uint32_t>  index;           //!< index[b] is the position of the first key with high bits greater than or equal to b
+      int                    index_shift = 0; //!< Right shift taking a key to its index bucket
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      constexpr static size_type interp_window = 8; //!< Number of keys checked around an interpolation guess
+      //@}
+
+    public:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @brief Constant forward iterator for MR_sorted_map.  Elements are visited in key order, and are returned by value. */
+      class const_iterator {
+        public:
+          /** Holds an element so that operator->() has something to point at. */
+          struct arrow_proxy {
+            value_type elt;
+            const value_type* operator->() const { return &elt; }
+          };
+          typedef std::forward_iterator_tag iterator_category;
+          typedef MR_sorted_map::value_type value_type;
+          typedef std::ptrdiff_t            difference_type;
+          typedef arrow_proxy               pointer;
+          typedef value_type                reference;
+          const_iterator() = default;
+          const_iterator(const MR_sorted_map* new_map, size_type new_idx) : map(new_map), idx(new_idx) { }
+          reference       operator*()  const { return value_type(map->keys[idx], map->vals[idx]); }
+          pointer         operator->() const { return arrow_proxy{**this}; }
+          const_iterator& operator++()       { idx++; return *this; }
+          const_iterator  operator++(int)    { const_iterator tmp = *this; ++(*this); return tmp; }
+          bool operator==(const const_iterator& other) const { return (idx == other.idx); }
+        private:
+          const MR_sorted_map* map = nullptr;
+          size_type            idx = 0;
+      };
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** The iterator type.  Elements may not be modified via iterators, so this is the same as const_iterator. */
+      typedef const_iterator iterator;
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Constructors */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct an empty map. */
+      MR_sorted_map() { build_index(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Construct from a range of elements with `first` (key) & `second` (value) members.  Keys must be unique.
+          @param first Iterator to first element
+          @param last  Iterator past the last element */
+      template <class input_itr_t>
+      MR_sorted_map(input_itr_t first, input_itr_t last) {
+        std::vector<key_t> tmp_keys;
+        std::vector<val_t> tmp_vals;
+        for(; first!=last; ++first) {
+          tmp_keys.push_back(first->first);
+          tmp_vals.push_back(first->second);
+        }
+        std::vector<size_type> order(tmp_keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&tmp_keys](size_type a, size_type b) { return (tmp_keys[a] < tmp_keys[b]); });
+        keys.reserve(order.size());
+        vals.reserve(order.size());
+        for(auto i: order) {
+          keys.push_back(tmp_keys[i]);
+          vals.push_back(tmp_vals[i]);
+        }
+        build_index();
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Capacity */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements in the map */
+      inline size_type size() const { return keys.size(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** True if the map holds no elements */
+      inline bool empty() const { return keys.empty(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of slots.  There are no empty slots, so this is size(). */
+      inline size_type bucket_count() const { return keys.size(); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Load factor.  There are no empty slots, so this is one. */
+      inline float load_factor() const { return 1.0f; }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Lookup */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Test if key is in the map
+          @param key Key to search for */
+      inline bool contains(const key_t& key) const { return (find_idx(key) < keys.size()); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Number of elements with the given key (0 or 1)
+          @param key Key to search for */
+      inline size_type count(const key_t& key) const { return (contains(key) ? 1 : 0); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find an element
+          @param key Key to search for
+          @return Iterator to the element, or cend() if key is not in the map */
+      inline const_iterator find(const key_t& key) const { return const_iterator(this, std::min(find_idx(key), keys.size())); }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Access an element with bounds checking.
+          @param key Key to search for
+          @return Reference to the mapped value
+          @throws std::out_of_range if key is not in the map */
+      inline const val_t& at(const key_t& key) const {
+        size_type idx = find_idx(key);
+        if (idx >= keys.size())
+          throw std::out_of_range("MR_sorted_map::at");
+        return vals[idx];
+      }
+      //@}
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Iterators */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      inline const_iterator cbegin() const { return const_iterator(this, 0);           } //!< Iterator to first element
+      inline const_iterator cend()   const { return const_iterator(this, keys.size()); } //!< Iterator past the last element
+      inline const_iterator begin()  const { return cbegin();                          } //!< Iterator to first element
+      inline const_iterator end()    const { return cend();                            } //!< Iterator past the last element
+      //@}
+
+    private:
+
+      //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+      /** @name Search Mechanics */
+      //@{
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Build the high bit index.  We use about one bucket for every four keys. */
+      void build_index() {
+        int index_bits = std::max(1, static_cast<int>(std::bit_width(keys.size() / 4)));
+        int key_bits   = (keys.empty() ? 1 : static_cast<int>(std::bit_width(static_cast<uint64_t>(keys.back()))));
+        index_bits     = std::min(index_bits, key_bits);
+        index_shift    = key_bits - index_bits;
+        size_type num_buckets = static_cast<size_type>(1) << index_bits;
+        index.assign(num_buckets + 1, static_cast<uint32_t>(keys.size()));
+        size_type b = 0;
+        for(size_type i=0; i<keys.size(); i++) {
+          size_type kb = static_cast<size_type>(static_cast<uint64_t>(keys[i]) >> index_shift);
+          while (b <= kb)
+            index[b++] = static_cast<uint32_t>(i);
+        }
+      }
+      //--------------------------------------------------------------------------------------------------------------------------------------------------------
+      /** Find the position of key.
+
+          The high bit index gives a bucket of keys to search.  Keys in a bucket are usually close to evenly spaced (a bucket of an MR_rect_tree store is
+          typically part of one row of a lattice), so we first guess a position by linear interpolation between the first and last keys in the bucket, and
+          check a few keys around the guess.  If that fails we fall back to a branch free binary search over the bucket.
+
+          @return The position, or a value greater than or equal to size() if key is not in the map. */
+      inline size_type find_idx(const key_t& key) const {
+        size_type kb = static_cast<size_type>(static_cast<uint64_t>(key) >> index_shift);
+        if (kb + 1 >= index.size())
+          return keys.size();
+        size_type base = index[kb];
+        size_type len  = index[kb+1] - base;
+        if (len == 0)
+          return keys.size();
+        // Interpolation guess
+        key_t lo_key = keys[base];
+        key_t hi_key = keys[base+len-1];
+        if ((key < lo_key) || (key > hi_key))
+          return keys.size();
+        if (len > interp_window) {
+          size_type guess = base + static_cast<size_type>(static_cast<double>(key - lo_key) / static_cast<double>(hi_key - lo_key + 1) * static_cast<double>(len));
+          size_type lo    = (guess > base + interp_window / 2 ? guess - interp_window / 2 : base);
+          lo              = std::min(lo, base + len - interp_window);
+          if ((keys[lo] <= key) && (key <= keys[lo + interp_window - 1])) {
+            base = lo;
+            len  = interp_window;
+          }
+        }
+        // Branch free lower bound: the comparison result is used as a multiplier instead of a branch condition.
+        while (len > 1) {
+          size_type half = len / 2;
+          base += static_cast<size_type>(keys[base + half - 1] < key) * half;
+          len  -= half;
+        }
+        if (keys[base] == key)
+          return base;
+        return keys.size();
+      }
+      //@}
+  };
+}
+
+#define MJR_INCLUDE_MR_sorted_map
+#endif
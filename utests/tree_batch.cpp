@@ -0,0 +1,188 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_batch.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree batch & async sample functions.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_batch, grid) {
+// What we are testing:
+//   - refine_grid with a batch function produces the same samples as with a scalar function
+//   - Blocks never exceed the batch size
+//   - make_batch_func adapts a scalar function
+
+  typedef mjr::MR_rect_tree<7, double, 2, 2> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return tt_t::rrpt_t({x[0]*x[1], x[0]-x[1]}); };
+
+  std::size_t num_calls = 0;
+  std::size_t max_block = 0;
+  auto bf = [&num_calls, &max_block](const tt_t::drpt_batch_t& x, const tt_t::rrpt_batch_t& y) {
+    num_calls++;
+    max_block = std::max(max_block, x[0].size());
+    for(std::size_t k=0; k<x[0].size(); k++) {
+      y[0][k] = x[0][k]*x[1][k];
+      y[1][k] = x[0][k]-x[1][k];
+    }
+  };
+
+  tt_t tree;
+  tree.refine_grid(3, f);
+
+  tt_t btree;
+  btree.set_sample_batch_size(10);
+  EXPECT_EQ(btree.get_sample_batch_size(), 10u);
+  btree.refine_grid(3, bf);
+  EXPECT_EQ(btree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(max_block, 10u);
+  EXPECT_EQ(num_calls, (tree.get_sample_count()+9)/10);
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(btree.get_sample(itr->first), itr->second);
+
+  tt_t atree;
+  atree.refine_grid(3, tt_t::make_batch_func(f));
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(atree.get_sample(itr->first), itr->second);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_batch, refine) {
+// What we are testing:
+//   - Batch refine_once & predicate refiners produce the same tree as scalar functions
+//   - Points are only sampled once
+
+  typedef mjr::MR_rect_tree<10, double, 3, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+
+  std::size_t num_points = 0;
+  auto bf = tt_t::make_batch_func([&num_points, &f](tt_t::drpt_t x) { num_points++; return f(x); });
+
+  tt_t tree, btree;
+  tree.refine_grid(1, f);
+  btree.refine_grid(1, f);
+
+  EXPECT_EQ(btree.refine_once(btree.ccc_get_top_cell(), bf), tree.refine_once(tree.ccc_get_top_cell(), f));
+  EXPECT_EQ(btree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(num_points, 0u);  // refine_grid(1) already sampled everything refine_once needs
+
+  tree.refine_leaves_recursive_cell_pred(5, f,   [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); });
+  btree.refine_leaves_recursive_cell_pred(5, bf, [&btree](tt_t::diti_t c) { return btree.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(btree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(btree.get_leaf_cells(), tree.get_leaf_cells());
+
+  std::size_t old_count = btree.get_sample_count();
+  EXPECT_EQ(btree.refine_leaves_once_if_cell_pred(6, bf,  [&btree](tt_t::diti_t c) { return btree.cell_cross_range_level(c, 0, 0.0); }),
+            tree.refine_leaves_once_if_cell_pred(6, f,    [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); }));
+  EXPECT_EQ(btree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(btree.get_leaf_cells(), tree.get_leaf_cells());
+
+  std::size_t before_count = btree.get_sample_count();
+  num_points = 0;
+  tree.refine_leaves_atomically_if_cell_pred(7, f,   [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); });
+  btree.refine_leaves_atomically_if_cell_pred(7, bf, [&btree](tt_t::diti_t c) { return btree.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(btree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(btree.get_leaf_cells(), tree.get_leaf_cells());
+  EXPECT_GT(btree.get_sample_count(), old_count);
+  EXPECT_EQ(num_points, btree.get_sample_count() - before_count);
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(btree.get_sample(itr->first), itr->second);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_batch, async) {
+// What we are testing:
+//   - Async refine_grid, refine_once, & predicate refiners produce the same tree as scalar functions
+//   - No more than the async window of evaluations are ever running at once
+//   - Points are only sampled once
+
+  typedef mjr::MR_rect_tree<10, double, 2, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  std::atomic<int>         num_running = 0;
+  std::atomic<int>         max_running = 0;
+  std::atomic<std::size_t> num_points  = 0;
+  auto af = [&](tt_t::drpt_t x) {
+    num_points++;
+    return std::async(std::launch::async, [&, x]() {
+                                            int r = ++num_running;
+                                            for(int m=max_running; (r > m) && !max_running.compare_exchange_weak(m, r); )
+                                              ;
+                                            double v = f(x);
+                                            num_running--;
+                                            return v;
+                                          });
+  };
+
+  tt_t tree, atree;
+  atree.set_async_window(5);
+  EXPECT_EQ(atree.get_async_window(), 5u);
+
+  tree.refine_grid(3, f);
+  atree.refine_grid_async(3, af);
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(num_points, tree.get_sample_count());
+
+  num_points = 0;
+  std::size_t old_count = atree.get_sample_count();
+  tree.refine_leaves_recursive_cell_pred(6, f,        [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); });
+  atree.refine_leaves_recursive_cell_pred_async(6, af, [&atree](tt_t::diti_t c) { return atree.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(atree.get_leaf_cells(), tree.get_leaf_cells());
+  EXPECT_EQ(num_points, atree.get_sample_count() - old_count);
+
+  tt_t::diti_t leaf = tree.get_leaf_cells().front();
+  EXPECT_EQ(atree.refine_once_async(leaf, af), tree.refine_once(leaf, f));
+  tree.refine_recursive_cell_pred(leaf, 8, f,         [&tree](tt_t::diti_t c)  { return tree.diti_to_drpt(c)[0] < -0.9; });
+  atree.refine_recursive_cell_pred_async(leaf, 8, af, [&atree](tt_t::diti_t c) { return atree.diti_to_drpt(c)[0] < -0.9; });
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(atree.get_leaf_cells(), tree.get_leaf_cells());
+
+  EXPECT_EQ(atree.refine_leaves_once_if_cell_pred_async(7, af, [&atree](tt_t::diti_t c) { return atree.cell_cross_range_level(c, 0, 0.0); }),
+            tree.refine_leaves_once_if_cell_pred(7, f,         [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); }));
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(atree.get_leaf_cells(), tree.get_leaf_cells());
+
+  tree.refine_leaves_atomically_if_cell_pred(7, f,         [&tree](tt_t::diti_t c)  { return tree.cell_cross_range_level(c, 0, 0.0); });
+  atree.refine_leaves_atomically_if_cell_pred_async(7, af, [&atree](tt_t::diti_t c) { return atree.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(atree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(atree.get_leaf_cells(), tree.get_leaf_cells());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(atree.get_sample(itr->first), itr->second);
+
+  EXPECT_GE(max_running, 1);
+  EXPECT_LE(max_running, 5);
+}
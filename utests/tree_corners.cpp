@@ -149,3 +149,43 @@ TEST(tree_corners, NA) {
         EXPECT_LT(tree4.ccc_get_corners(0x40404040, dim, dir)[i], tree4.ccc_get_corners(0x40404040, dim, dir)[i+1]);
 
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class tt_t>
+void check_array_variants(const tt_t& tree, typename tt_t::diti_t cell) {
+  auto to_list = [](auto a) { return typename tt_t::diti_list_t(a.cbegin(), a.cend()); };
+  EXPECT_EQ(to_list(tree.ccc_get_corners_array(cell)),  tree.ccc_get_corners(cell));
+  EXPECT_EQ(to_list(tree.ccc_get_vertexes_array(cell)), tree.ccc_get_vertexes(cell));
+  EXPECT_EQ(to_list(tree.ccc_get_children_array(cell)), tree.ccc_get_children(cell));
+  for(int i=0; i<tt_t::domain_dimension; i++) {
+    for(int d=-1; d<2; d+=2) {
+      EXPECT_EQ(to_list(tree.ccc_get_corners_array(cell, i, d)),  tree.ccc_get_corners(cell, i, d));
+      EXPECT_EQ(to_list(tree.ccc_get_children_array(cell, i, d)), tree.ccc_get_children(cell, i, d));
+    }
+  }
+  typename tt_t::diti_axis_t nbrs;
+  int num_nbrs = tree.ccc_get_neighbors_array(cell, nbrs);
+  EXPECT_EQ(typename tt_t::diti_list_t(nbrs.cbegin(), nbrs.cbegin()+num_nbrs), tree.ccc_get_neighbors(cell));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_corners, arrays) {
+// What we are testing:
+//   - The allocation free *_array variants return the same points, in the same order, as the std::vector versions
+
+  mjr::tree7b1d1rT tree1;
+  check_array_variants(tree1, tree1.ccc_get_top_cell());
+  check_array_variants(tree1, 0x20);
+
+  mjr::tree7b2d1rT tree2;
+  check_array_variants(tree2, tree2.ccc_get_top_cell());
+  check_array_variants(tree2, 0x2020);
+  check_array_variants(tree2, 0x6020);
+
+  mjr::tree7b3d1rT tree3;
+  check_array_variants(tree3, tree3.ccc_get_top_cell());
+  check_array_variants(tree3, 0x602020);
+
+  mjr::tree7b4d1rT tree4;
+  check_array_variants(tree4, tree4.ccc_get_top_cell());
+}
@@ -0,0 +1,157 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_interp.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree point location & interpolation.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_interp, locate_leaf) {
+// What we are testing:
+//   - locate_leaf() returns the leaf holding the point
+//   - Points outside the bounding box, & points in an empty tree, are not located
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree({-1.0, -2.0}, {1.0, 2.0});
+  EXPECT_EQ(tree.locate_leaf({0.1, 0.2}), 0u);
+  tree.refine_grid(2, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+
+  for(int i=0; i<=50; i++) {
+    for(int j=0; j<=50; j++) {
+      tt_t::drpt_t x({-1.0+2.0*i/50.0, -2.0+4.0*j/50.0});
+      tt_t::diti_t leaf = tree.locate_leaf(x);
+      ASSERT_NE(leaf, 0u);
+      EXPECT_FALSE(tree.cell_has_child(leaf));
+      tt_t::diti_corners_t corners = tree.ccc_get_corners_array(leaf);
+      tt_t::drpt_t lo = tree.diti_to_drpt(corners.front());
+      tt_t::drpt_t hi = tree.diti_to_drpt(corners.back());
+      EXPECT_TRUE((lo[0] <= x[0]) && (x[0] <= hi[0]));
+      EXPECT_TRUE((lo[1] <= x[1]) && (x[1] <= hi[1]));
+    }
+  }
+
+  EXPECT_EQ(tree.locate_leaf({ 1.1,  0.0}), 0u);
+  EXPECT_EQ(tree.locate_leaf({ 0.0, -2.1}), 0u);
+  EXPECT_EQ(tree.locate_leaf({ std::nan(""), 0.0}), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_interp, interpolate_2d) {
+// What we are testing:
+//   - Both schemes reproduce the samples
+//   - Multilinear interpolation is exact for bilinear functions
+//   - Center aware interpolation is exact for linear functions
+//   - interpolate_many() matches interpolate()
+//   - Points outside the bounding box are NaN
+
+  typedef mjr::MR_rect_tree<7, double, 2, 2> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return tt_t::rrpt_t({1.0+2.0*x[0]-3.0*x[1]+x[0]*x[1], 0.5*x[0]+x[1]}); };
+
+  tt_t tree({-1.0, -1.0}, {1.0, 3.0});
+  tree.refine_grid(2, f);
+  tree.refine_leaves_recursive_cell_pred(5, f, [&tree](tt_t::diti_t c) { tt_t::drpt_t x = tree.diti_to_drpt(c); return (x[0]*x[0]+x[1]*x[1] < 0.8); });
+
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr) {
+    tt_t::drpt_t x = tree.diti_to_drpt(itr->first);
+    EXPECT_NEAR(tree.interpolate(x, false)[0], itr->second[0], 1e-12);
+    EXPECT_NEAR(tree.interpolate(x, true)[0],  itr->second[0], 1e-12);
+  }
+
+  std::vector<double> xs, ys;
+  for(int i=0; i<=40; i++) {
+    for(int j=0; j<=40; j++) {
+      tt_t::drpt_t x({-1.0+2.0*(i+0.3)/41.0, -1.0+4.0*(j+0.6)/41.0});
+      xs.push_back(x[0]);
+      ys.push_back(x[1]);
+      EXPECT_NEAR(tree.interpolate(x, false)[0], f(x)[0], 1e-12);
+      EXPECT_NEAR(tree.interpolate(x, false)[1], f(x)[1], 1e-12);
+      EXPECT_NEAR(tree.interpolate(x, true)[1],  f(x)[1], 1e-12);
+    }
+  }
+  xs.push_back(5.0);
+  ys.push_back(0.0);
+
+  for(bool use_center: {false, true}) {
+    std::vector<double> r0(xs.size()), r1(xs.size());
+    tree.interpolate_many({std::span<const double>(xs), std::span<const double>(ys)}, {std::span<double>(r0), std::span<double>(r1)}, use_center);
+    for(std::size_t k=0; k<xs.size()-1; k++) {
+      tt_t::rrpt_t v = tree.interpolate({xs[k], ys[k]}, use_center);
+      EXPECT_EQ(r0[k], v[0]);
+      EXPECT_EQ(r1[k], v[1]);
+    }
+    EXPECT_TRUE(std::isnan(r0.back()));
+    EXPECT_TRUE(std::isnan(r1.back()));
+  }
+
+  EXPECT_TRUE(std::isnan(tree.interpolate({0.0, 3.5})[0]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_interp, interpolate_3d) {
+// What we are testing:
+//   - Trilinear interpolation is exact for trilinear functions
+//   - Center aware interpolation is exact for linear functions, & reproduces center samples
+
+  typedef mjr::MR_rect_tree<5, double, 3, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return 1.0+x[0]-2.0*x[1]+0.5*x[2]+x[0]*x[1]*x[2]; };
+  auto g = [](tt_t::drpt_t x) { return 1.0+x[0]-2.0*x[1]+0.5*x[2]; };
+
+  tt_t ftree, gtree;
+  ftree.refine_grid(1, f);
+  ftree.refine_leaves_recursive_cell_pred(3, f, [&ftree](tt_t::diti_t c) { return ftree.diti_to_drpt(c)[0] < 0.3; });
+  gtree.refine_grid(2, g);
+
+  for(int i=0; i<=10; i++) {
+    for(int j=0; j<=10; j++) {
+      for(int k=0; k<=10; k++) {
+        tt_t::drpt_t x({i/10.0, (j+0.3)/11.0, (k+0.7)/11.0});
+        EXPECT_NEAR(ftree.interpolate(x, false), f(x), 1e-12);
+        EXPECT_NEAR(gtree.interpolate(x, true),  g(x), 1e-12);
+      }
+    }
+  }
+
+  for(auto leaf: ftree.get_leaf_cells()) {
+    tt_t::drpt_t x = ftree.diti_to_drpt(leaf);
+    EXPECT_EQ(ftree.locate_leaf(x), leaf);
+    EXPECT_NEAR(ftree.interpolate(x, true), f(x), 1e-12);
+  }
+}
@@ -0,0 +1,164 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_journal.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree journals.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_journal, resume) {
+// What we are testing:
+//   - resume_from_journal restores every journaled sample, and rerunning the leaf refinement only evaluates new points
+//   - After resume_from_journal refine_grid skips existing points until the journal is closed
+//   - Journals hold samples present when they were opened, & samples from batch functions
+//   - Torn records are ignored
+//   - Journals for other bounding boxes are rejected
+//   - Changing the bounding box after resume_from_journal leaves the journal file alone, and refine_grid still skips existing points
+//   - Copies of a tree do not write to the journal
+
+  typedef mjr::MR_rect_tree<10, double, 2, 1> tt_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_journal_resume.jrnl").string();
+
+  std::size_t num_calls = 0;
+  auto f  = [&num_calls](tt_t::drpt_t x) { num_calls++; return x[0]*x[0]+x[1]*x[1]-0.5; };
+  auto bf = tt_t::make_batch_func(f);
+
+  tt_t tree;
+  tree.refine_grid(2, f);
+  EXPECT_FALSE(tree.journal_is_open());
+  EXPECT_EQ(tree.flush_journal(), 1);
+  EXPECT_EQ(tree.open_journal(file_name), 0);
+  EXPECT_TRUE(tree.journal_is_open());
+  tree.refine_grid(6, bf);
+  tree.refine_leaves_recursive_cell_pred(8, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(tree.flush_journal(), 0);
+  tt_t ctree = tree;
+  EXPECT_FALSE(ctree.journal_is_open());
+  ctree.refine_leaves_recursive_cell_pred(9, f, [&ctree](tt_t::diti_t c) { return ctree.cell_cross_range_level(c, 0, 0.0); });
+  tree.close_journal();
+  EXPECT_GT(std::filesystem::file_size(file_name), 24 + tree.get_sample_count() * (sizeof(tt_t::diti_t) + sizeof(tt_t::srpt_t)) - 1);
+
+  {
+    std::ofstream out(file_name, std::ios::binary | std::ios::app);
+    out.write("torn", 4);
+  }
+
+  tt_t tree2;
+  EXPECT_EQ(tree2.resume_from_journal(file_name), 0);
+  EXPECT_TRUE(tree2.journal_is_open());
+  EXPECT_EQ(tree2.get_sample_count(), tree.get_sample_count());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(tree2.get_sample(itr->first), itr->second);
+
+  num_calls = 0;
+  tree2.refine_grid(6, f);
+  tree2.refine_grid(6, bf);
+  EXPECT_EQ(num_calls, 0u);
+  tree2.refine_leaves_recursive_cell_pred(8, f, [&tree2](tt_t::diti_t c) { return tree2.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(num_calls, 0u);
+  tree2.refine_leaves_recursive_cell_pred(9, f, [&tree2](tt_t::diti_t c) { return tree2.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(num_calls, ctree.get_sample_count() - tree.get_sample_count());
+  tree2.close_journal();
+
+  tt_t tree3;
+  EXPECT_EQ(tree3.resume_from_journal(file_name), 0);
+  EXPECT_EQ(tree3.get_sample_count(), ctree.get_sample_count());
+  for(auto itr=ctree.cbegin_samples(); itr!=ctree.cend_samples(); ++itr)
+    EXPECT_EQ(tree3.get_sample(itr->first), itr->second);
+  tree3.close_journal();
+  num_calls = 0;
+  tree3.refine_grid(1, f);
+  EXPECT_EQ(num_calls, 13u);
+
+  tt_t tree4({-2.0, -2.0}, {2.0, 2.0});
+  EXPECT_EQ(tree4.resume_from_journal(file_name), 1);
+  EXPECT_FALSE(tree4.journal_is_open());
+  EXPECT_EQ(tree4.get_sample_count(), 0u);
+
+  tt_t tree5;
+  EXPECT_EQ(tree5.resume_from_journal(file_name), 0);
+  EXPECT_EQ(tree5.flush_journal(), 0);
+  std::uintmax_t journal_size = std::filesystem::file_size(file_name);
+  tree5.set_bbox({-2.0, -2.0}, {2.0, 2.0});
+  EXPECT_FALSE(tree5.journal_is_open());
+  EXPECT_EQ(tree5.get_sample_count(), ctree.get_sample_count());
+  num_calls = 0;
+  tree5.refine_grid(6, f);
+  EXPECT_EQ(num_calls, 0u);
+  tree5.refine_grid(7, f);
+  EXPECT_GT(num_calls, 0u);
+  EXPECT_EQ(std::filesystem::file_size(file_name), journal_size);
+  tt_t tree6;
+  EXPECT_EQ(tree6.resume_from_journal(file_name), 0);
+  EXPECT_EQ(tree6.get_sample_count(), ctree.get_sample_count());
+  tree6.close_journal();
+
+  std::filesystem::remove(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_journal, parallel) {
+// What we are testing:
+//   - Samples taken by the *_parallel() refiners are journaled, and resuming skips them
+
+  typedef mjr::MR_rect_tree<8, double, 2, 1, mjr::MR_sharded_map> tt_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_journal_parallel.jrnl").string();
+
+  std::atomic<std::size_t> num_calls = 0;
+  auto f = [&num_calls](tt_t::drpt_t x) { num_calls++; return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree;
+  tree.set_thread_count(4);
+  EXPECT_EQ(tree.open_journal(file_name), 0);
+  tree.refine_grid(3, f);
+  tree.refine_leaves_recursive_cell_pred_parallel(8, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+  tree.close_journal();
+
+  tt_t tree2;
+  tree2.set_thread_count(4);
+  EXPECT_EQ(tree2.resume_from_journal(file_name), 0);
+  EXPECT_EQ(tree2.get_sample_count(), tree.get_sample_count());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(tree2.get_sample(itr->first), itr->second);
+  num_calls = 0;
+  tree2.refine_grid(3, f);
+  tree2.refine_leaves_recursive_cell_pred_parallel(8, f, [&tree2](tt_t::diti_t c) { return tree2.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(num_calls, 0u);
+  tree2.close_journal();
+
+  std::filesystem::remove(file_name);
+}
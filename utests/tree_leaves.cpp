@@ -0,0 +1,296 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_leaves.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree leaf cell enumeration.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Check the leaf index against a tree walk for the top cell, & every interior cell
+template <class tree_t>
+void check_leaf_index(const tree_t& tree) {
+  typename tree_t::diti_list_t walk;
+  tree.append_leaf_cells(tree.ccc_get_top_cell(), walk);
+  EXPECT_EQ(tree.get_leaf_cells(), walk);
+  EXPECT_EQ(tree.count_leaf_cells(tree.ccc_get_top_cell()), static_cast<int>(walk.size()));
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr) {
+    if (tree.cell_good_center(itr->first) && tree.cell_has_child(itr->first)) {
+      typename tree_t::diti_list_t sub;
+      tree.append_leaf_cells(itr->first, sub);
+      EXPECT_EQ(tree.get_leaf_cells(itr->first), sub);
+      EXPECT_EQ(tree.count_leaf_cells(itr->first), static_cast<int>(sub.size()));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_leaves, cell_good_center) {
+// What we are testing:
+//   - cell_good_center() accepts cell centers, and rejects other points
+
+  typedef mjr::MR_rect_tree<5, double, 2, 1> tt_t;
+  tt_t tree;
+
+  EXPECT_TRUE( tree.cell_good_center(tree.ccc_get_top_cell()));
+  EXPECT_TRUE( tree.cell_good_center(tree.dita_to_diti({1, 3})));
+  EXPECT_TRUE( tree.cell_good_center(tree.dita_to_diti({6, 2})));
+  EXPECT_TRUE( tree.cell_good_center(tree.dita_to_diti({8, 24})));
+  EXPECT_FALSE(tree.cell_good_center(tree.dita_to_diti({0, 0})));
+  EXPECT_FALSE(tree.cell_good_center(tree.dita_to_diti({0, 16})));
+  EXPECT_FALSE(tree.cell_good_center(tree.dita_to_diti({2, 3})));
+  EXPECT_FALSE(tree.cell_good_center(tree.dita_to_diti({32, 16})));
+  EXPECT_FALSE(tree.cell_good_center(tree.dita_to_diti({16, 32})));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_leaves, index) {
+// What we are testing:
+//   - The leaf index matches a tree walk after each kind of refinement (1D, 2D, & 3D)
+
+  typedef mjr::MR_rect_tree<9, double, 1, 1> t1_t;
+  t1_t tree1;
+  EXPECT_EQ(tree1.count_leaf_cells(tree1.ccc_get_top_cell()), 1);
+  tree1.refine_grid(2, [](double x) { return x; });
+  tree1.refine_leaves_recursive_cell_pred(8, [](double x) { return x; }, [&tree1](t1_t::diti_t c) { return tree1.diti_to_drpt(c) < 0.2; });
+  check_leaf_index(tree1);
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> t2_t;
+  auto f2 = [](t2_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+  auto p2 = [](t2_t& t) { return [&t](t2_t::diti_t c) { return t.cell_cross_range_level(c, 0, 0.0); }; };
+  t2_t tree2({-1.0, -1.0}, {1.0, 1.0});
+  tree2.refine_grid(2, f2);
+  check_leaf_index(tree2);
+  tree2.refine_leaves_recursive_cell_pred(4, f2, p2(tree2));
+  check_leaf_index(tree2);
+  tree2.refine_leaves_recursive_cell_pred(5, t2_t::make_batch_func(f2), p2(tree2));
+  check_leaf_index(tree2);
+  tree2.set_thread_count(3);
+  tree2.refine_leaves_once_if_cell_pred(6, f2, p2(tree2));
+  check_leaf_index(tree2);
+  tree2.balance_tree(1, f2);
+  check_leaf_index(tree2);
+  tree2.refine_grid(3, f2);  // Resamples existing points
+  check_leaf_index(tree2);
+  EXPECT_GT(tree2.pack_bricks(1, 2), 0);
+  tree2.refine_leaves_recursive_cell_pred(6, f2, [&tree2](t2_t::diti_t c) { return tree2.diti_to_drpt(c)[0] > 0.8; });
+  check_leaf_index(tree2);
+
+  t2_t tree2c = tree2;
+  check_leaf_index(tree2c);
+  t2_t::frozen_t ftree = tree2.freeze();
+  check_leaf_index(ftree);
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_leaves_index.mrpt").string();
+  EXPECT_EQ(tree2.save(file_name), 0);
+  t2_t tree2l;
+  tree2l.refine_grid(1, f2);
+  EXPECT_EQ(tree2l.load(file_name), 0);
+  check_leaf_index(tree2l);
+  std::filesystem::remove(file_name);
+
+  typedef mjr::MR_rect_tree<6, double, 3, 1, mjr::MR_sharded_map> t3_t;
+  auto f3 = [](t3_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+  t3_t tree3;
+  tree3.refine_grid(1, f3);
+  tree3.set_thread_count(3);
+  tree3.refine_leaves_recursive_cell_pred_parallel(4, f3, [&tree3](t3_t::diti_t c) { return tree3.cell_cross_range_level(c, 0, 0.0); });
+  check_leaf_index(tree3);
+  tree3.refine_leaves_recursive_cell_pred(5, f3, [&tree3](t3_t::diti_t c) { return tree3.cell_cross_range_level(c, 0, 0.0); });
+  check_leaf_index(tree3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_leaves, index_parallel_query) {
+// What we are testing:
+//   - The leaf index is correct after a parallel refinement whose predicate queries leaves mid run
+//   - Leaf queries made mid run (count_leaf_cells() & leaves()) walk the tree, and see at least the leaves of the starting grid
+//   - Copies of a tree taken while other threads query the leaf index
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1, mjr::MR_sharded_map> tt_t;
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree({-1.0, -1.0}, {1.0, 1.0});
+  tree.refine_grid(2, f);
+  tree.set_thread_count(4);
+  std::atomic<bool> queried = false;
+  std::atomic<int>  num_walked = 0, num_counted = 0;
+  auto p = [&tree, &queried, &num_walked, &num_counted](tt_t::diti_t c) {
+    if ( !(queried.exchange(true))) {
+      num_counted = tree.count_leaf_cells(tree.ccc_get_top_cell());
+      num_walked  = static_cast<int>(std::ranges::distance(tree.leaves()));
+    }
+    return tree.cell_cross_range_level(c, 0, 0.0);
+  };
+  tree.refine_leaves_recursive_cell_pred_parallel(7, f, p);
+  EXPECT_TRUE(queried);
+  EXPECT_GE(num_walked, 16);
+  EXPECT_GE(num_counted, 16);
+  check_leaf_index(tree);
+
+  queried = false;
+  tree.refine_recursive_cell_pred_parallel(tree.ccc_get_top_cell(), -1, f, [&tree, &queried](tt_t::diti_t c) {
+    if ( !(queried.exchange(true)))
+      tree.count_leaf_cells(tree.ccc_get_top_cell());
+    return tree.diti_to_drpt(c)[0] > 0.5;
+  });
+  EXPECT_TRUE(queried);
+
+  {  // The index is stale here, so the reader rebuilds it while the copies are made
+    std::jthread reader([&tree]() { for(int i=0; i<100; i++) tree.get_leaf_cells(); });
+    for(int i=0; i<100; i++) {
+      tt_t tree_copy = tree;
+      EXPECT_EQ(tree_copy.get_sample_count(), tree.get_sample_count());
+    }
+  }
+  check_leaf_index(tree);
+  tt_t tree_copy = tree;
+  check_leaf_index(tree_copy);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_leaves, ranges) {
+// What we are testing:
+//   - leaves() & leaves_pred() visit the same cells, in the same order, as get_leaf_cells() & get_leaf_cells_pred()
+//   - Level limits, subtrees, & leaf cells -- with & without the leaf index
+//   - The ranges work with std::ranges algorithms
+//   - Iterator equality tracks the traversal state, and ranges kept while the tree is refined see the refined tree
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  static_assert(std::ranges::forward_range<tt_t::leaf_range_t<>>);
+
+  tt_t tree({-1.0, -1.0}, {1.0, 1.0});
+  for(auto c: tree.leaves())
+    EXPECT_EQ(c, tree.ccc_get_top_cell());
+  EXPECT_EQ(std::ranges::distance(tree.leaves()), 1);
+
+  tree.refine_grid(2, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+
+  tt_t::diti_list_t all(tree.leaves().begin(), tree.leaves().end());
+  EXPECT_EQ(all, tree.get_leaf_cells());
+
+  auto pred = [&tree](tt_t::diti_t c) { return tree.diti_to_drpt(c)[0] > 0.1; };
+  tt_t::diti_list_t some;
+  for(auto c: tree.leaves_pred(pred))
+    some.push_back(c);
+  EXPECT_EQ(some, tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), pred));
+
+  tt_t::diti_list_t mid;
+  for(auto c: tree.get_leaf_cells())
+    if ((tree.ccc_cell_level(c) >= 3) && (tree.ccc_cell_level(c) <= 4))
+      mid.push_back(c);
+  tt_t::diti_list_t mid_range;
+  std::ranges::copy(tree.leaves(tree.ccc_get_top_cell(), 3, 4), std::back_inserter(mid_range));
+  EXPECT_EQ(mid_range, mid);
+
+  tt_t::diti_list_t deep;
+  for(auto c: tree.get_leaf_cells())
+    if (tree.ccc_cell_level(c) >= 5)
+      deep.push_back(c);
+  tt_t::diti_list_t deep_range(tree.leaves(tree.ccc_get_top_cell(), 5).begin(), tree.leaves(tree.ccc_get_top_cell(), 5).end());
+  EXPECT_EQ(deep_range, deep);
+
+  tt_t::diti_t sub = tree.ccc_get_children_array(tree.ccc_get_top_cell())[1];
+  EXPECT_EQ(std::ranges::distance(tree.leaves(sub)), tree.count_leaf_cells(sub));
+  tt_t::diti_list_t sub_walk;
+  tree.append_leaf_cells(sub, sub_walk);
+  EXPECT_EQ(tt_t::diti_list_t(tree.leaves(sub).begin(), tree.leaves(sub).end()), sub_walk);
+  tt_t::diti_t leaf = tree.get_leaf_cells().front();
+  EXPECT_EQ(tt_t::diti_list_t(tree.leaves(leaf).begin(), tree.leaves(leaf).end()), tt_t::diti_list_t({leaf}));
+  EXPECT_EQ(std::ranges::count_if(tree.leaves(), pred), static_cast<long>(some.size()));
+
+  auto kept      = tree.leaves();
+  auto kept_walk = tree.leaves(tree.ccc_get_top_cell(), 0, 7);
+  auto itr1      = kept_walk.begin();
+  auto itr2      = itr1;
+  EXPECT_TRUE(itr1 == itr2);
+  ++itr2;
+  EXPECT_FALSE(itr1 == itr2);
+  EXPECT_FALSE(itr2 == kept_walk.end());
+  itr1++;
+  EXPECT_TRUE(itr1 == itr2);
+  tree.refine_leaves_recursive_cell_pred(5, f, [&tree](tt_t::diti_t c) { return tree.diti_to_drpt(c)[0] > 0.8; });
+  EXPECT_NE(tree.get_leaf_cells(), all);
+  EXPECT_EQ(tt_t::diti_list_t(kept.begin(), kept.end()), tree.get_leaf_cells());
+  EXPECT_EQ(tt_t::diti_list_t(kept_walk.begin(), kept_walk.end()), tree.get_leaf_cells());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_leaves, pruned) {
+// What we are testing:
+//   - leaves_pruned() & get_leaf_cells_pruned() match get_leaf_cells_pred() for conservative subtree predicates
+//   - Subtrees failing the subtree predicate are not walked
+//   - The leaves_*_domain_* region queries match their cell_* predicates
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree({-1.0, -1.0}, {1.0, 1.0});
+  tree.refine_grid(3, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+
+  tt_t::drpt_t pt({0.5, 0.5});
+  auto near_pt = [&tree, pt](tt_t::diti_t c) { return tree.cell_near_domain_point(pt, 0.01, c); };
+  auto near_pt_sub = [&tree, pt](tt_t::diti_t c) { return tree.subtree_near_domain_point(pt, 0.01, c); };
+  tt_t::diti_list_t want = tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), near_pt);
+  EXPECT_FALSE(want.empty());
+  EXPECT_EQ(tree.get_leaf_cells_pruned(near_pt_sub, near_pt), want);
+  tt_t::diti_list_t got(tree.leaves_near_domain_point(pt, 0.01).begin(), tree.leaves_near_domain_point(pt, 0.01).end());
+  EXPECT_EQ(got, want);
+
+  int internal_visits = 0;
+  auto count_sub = [&](tt_t::diti_t c) { internal_visits++; return near_pt_sub(c); };
+  EXPECT_EQ(tree.get_leaf_cells_pruned(count_sub, near_pt), want);
+  int all_internal_visits = 0;
+  auto count_all = [&](tt_t::diti_t) { all_internal_visits++; return true; };
+  EXPECT_EQ(tree.get_leaf_cells_pruned(count_all, near_pt), want);
+  EXPECT_LT(4*internal_visits, all_internal_visits);
+
+  for(int i=0; i<2; i++) {
+    auto near_lv  = [&tree, i](tt_t::diti_t c) { return tree.cell_near_domain_level(c, i, 0.25, 1.0e-6); };
+    auto below_lv = [&tree, i](tt_t::diti_t c) { return tree.cell_below_domain_level(c, i, 0.25); };
+    auto above_lv = [&tree, i](tt_t::diti_t c) { return tree.cell_above_domain_level(c, i, 0.25); };
+    tt_t::diti_list_t near_cells, below_cells, above_cells;
+    std::ranges::copy(tree.leaves_near_domain_level(i, 0.25, 1.0e-6), std::back_inserter(near_cells));
+    std::ranges::copy(tree.leaves_below_domain_level(i, 0.25),        std::back_inserter(below_cells));
+    std::ranges::copy(tree.leaves_above_domain_level(i, 0.25),        std::back_inserter(above_cells));
+    EXPECT_EQ(near_cells,  tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), near_lv));
+    EXPECT_EQ(below_cells, tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), below_lv));
+    EXPECT_EQ(above_cells, tree.get_leaf_cells_pred(tree.ccc_get_top_cell(), above_lv));
+    EXPECT_EQ(near_cells.size()+below_cells.size()+above_cells.size(), static_cast<std::size_t>(tree.count_leaf_cells(tree.ccc_get_top_cell())));
+  }
+}
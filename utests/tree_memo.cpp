@@ -0,0 +1,186 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_memo.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree memo files.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_memo, rerun) {
+// What we are testing:
+//   - A second run with the same memo file makes no function calls, & gets the same samples
+//   - Copies of a tree do not use the memo file of the original
+//   - A different bounding box or function tag does not reuse results
+//   - A torn record at the end of the file is ignored
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_memo_rerun.memo").string();
+  std::filesystem::remove(file_name);
+
+  std::size_t num_calls = 0;
+  auto f = [&num_calls](tt_t::drpt_t x) { num_calls++; return x[0]*x[0]+x[1]; };
+  auto c = [](tt_t::diti_t) { return true; };
+
+  tt_t tree1;
+  EXPECT_FALSE(tree1.memo_file_is_open());
+  EXPECT_EQ(tree1.open_memo_file(file_name, "f"), 0);
+  EXPECT_TRUE(tree1.memo_file_is_open());
+  tree1.refine_grid(2, f);
+  tree1.refine_leaves_recursive_cell_pred(4, f, c);
+  EXPECT_EQ(num_calls, tree1.get_sample_count());
+  EXPECT_EQ(tree1.get_memo_hit_count(), 0u);
+  tt_t tree1c = tree1;
+  EXPECT_FALSE(tree1c.memo_file_is_open());
+  tree1c = tree1;
+  EXPECT_FALSE(tree1c.memo_file_is_open());
+  EXPECT_TRUE(tree1.memo_file_is_open());
+  tree1.close_memo_file();
+
+  num_calls = 0;
+  tt_t tree2;
+  EXPECT_EQ(tree2.open_memo_file(file_name, "f"), 0);
+  tree2.refine_grid(2, f);
+  tree2.refine_leaves_recursive_cell_pred(4, f, c);
+  EXPECT_EQ(num_calls, 0u);
+  EXPECT_EQ(tree2.get_memo_hit_count(), tree1.get_sample_count());
+  EXPECT_EQ(tree2.get_sample_count(), tree1.get_sample_count());
+  for(auto itr=tree1.cbegin_samples(); itr!=tree1.cend_samples(); ++itr)
+    EXPECT_EQ(tree2.get_sample(itr->first), itr->second);
+  tree2.close_memo_file();
+
+  num_calls = 0;
+  tt_t tree3({-2.0, -2.0}, {2.0, 2.0});
+  EXPECT_EQ(tree3.open_memo_file(file_name, "f"), 0);
+  tree3.refine_grid(2, f);
+  EXPECT_EQ(num_calls, tree3.get_sample_count());
+  EXPECT_EQ(tree3.get_memo_hit_count(), 0u);
+
+  num_calls = 0;
+  tt_t tree4;
+  EXPECT_EQ(tree4.open_memo_file(file_name, "g"), 0);
+  tree4.refine_grid(2, f);
+  EXPECT_EQ(num_calls, tree4.get_sample_count());
+  tree3.close_memo_file();
+  tree4.close_memo_file();
+
+  {
+    std::ofstream out(file_name, std::ios::binary | std::ios::app);
+    out.write("torn", 4);
+  }
+  num_calls = 0;
+  tt_t tree5;
+  EXPECT_EQ(tree5.open_memo_file(file_name, "f"), 0);
+  tree5.refine_grid(2, f);
+  EXPECT_EQ(num_calls, 0u);
+  EXPECT_EQ(std::filesystem::file_size(file_name) % (sizeof(uint64_t)+sizeof(tt_t::diti_t)+sizeof(tt_t::srpt_t)), 16u);
+  tree5.close_memo_file();
+
+  std::filesystem::remove(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_memo, batch) {
+// What we are testing:
+//   - Batch functions & parallel refinement use the memo file
+//   - The work stealing refiners (concurrent store) use the memo file, & add new results to it
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_memo_batch.memo").string();
+  std::filesystem::remove(file_name);
+
+  std::size_t num_calls = 0;
+  auto bf = [&num_calls](const tt_t::drpt_batch_t& x, const tt_t::rrpt_batch_t& y) {
+    for(std::size_t k=0; k<x[0].size(); k++) {
+      num_calls++;
+      y[0][k] = x[0][k]*x[1][k];
+    }
+  };
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[1]; };
+
+  tt_t tree1;
+  EXPECT_EQ(tree1.open_memo_file(file_name, "f"), 0);
+  tree1.refine_grid(3, bf);
+  EXPECT_EQ(num_calls, tree1.get_sample_count());
+  tree1.close_memo_file();
+
+  num_calls = 0;
+  tt_t tree2;
+  EXPECT_EQ(tree2.open_memo_file(file_name, "f"), 0);
+  tree2.refine_grid(4, bf);
+  EXPECT_EQ(num_calls, tree2.get_sample_count()-tree1.get_sample_count());
+  EXPECT_EQ(tree2.get_memo_hit_count(), tree1.get_sample_count());
+  tree2.close_memo_file();
+
+  tt_t tree3;
+  tree3.set_thread_count(4);
+  EXPECT_EQ(tree3.open_memo_file(file_name, "f"), 0);
+  tree3.refine_grid(4, f);
+  EXPECT_EQ(tree3.get_memo_hit_count(), tree2.get_sample_count());
+  for(auto itr=tree2.cbegin_samples(); itr!=tree2.cend_samples(); ++itr)
+    EXPECT_EQ(tree3.get_sample(itr->first), itr->second);
+  tree3.close_memo_file();
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1, mjr::MR_sharded_map> st_t;
+  std::atomic<std::size_t> num_sharded_calls = 0;
+  auto sf = [&num_sharded_calls](st_t::drpt_t x) { num_sharded_calls++; return x[0]*x[1]; };
+  auto sp = [](st_t::diti_t) { return true; };
+
+  st_t tree4;
+  tree4.set_thread_count(4);
+  EXPECT_EQ(tree4.open_memo_file(file_name, "f"), 0);
+  tree4.refine_grid(1, sf);
+  num_sharded_calls = 0;
+  tree4.refine_leaves_recursive_cell_pred_parallel(5, sf, sp);
+  EXPECT_EQ(tree4.get_sample_count(), 33*33+32*32);
+  EXPECT_EQ(tree4.get_memo_hit_count(), tree2.get_sample_count());
+  EXPECT_EQ(num_sharded_calls, tree4.get_sample_count() - tree2.get_sample_count());
+  tree4.close_memo_file();
+
+  num_sharded_calls = 0;
+  st_t tree5;
+  tree5.set_thread_count(4);
+  EXPECT_EQ(tree5.open_memo_file(file_name, "f"), 0);
+  tree5.refine_grid(1, sf);
+  tree5.refine_leaves_recursive_cell_pred_parallel(5, sf, sp);
+  EXPECT_EQ(num_sharded_calls, 0);
+  EXPECT_EQ(tree5.get_memo_hit_count(), tree5.get_sample_count());
+  for(auto itr=tree5.cbegin_samples(); itr!=tree5.cend_samples(); ++itr)
+    EXPECT_EQ(itr->second, sf(tree5.diti_to_drpt(itr->first)));
+  tree5.close_memo_file();
+
+  std::filesystem::remove(file_name);
+}
@@ -31,6 +31,8 @@
 /*******************************************************************************************************************************************************.H.E.**/
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 #include "MR_rect_tree.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -173,3 +175,95 @@ TEST(tree_neighbors, NA) {
 
   EXPECT_EQ(tree4.ccc_get_neighbors(0x40404040).size(),  0 );
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_neighbors, unbalanced) {
+// What we are testing:
+//   - cell_neighbor_level_exceeds() agrees with get_smallest_neighbor_level() for every leaf & a range of levels (1D, 2D, & 3D)
+//   - balance_tree() leaves no unbalanced cells
+
+  auto check = [](auto& tree, int delta_max) {
+    for(auto c: tree.get_leaf_cells())
+      for(int level=-1; level<=delta_max+static_cast<int>(tree.ccc_cell_level(c)); level++)
+        EXPECT_EQ(tree.cell_neighbor_level_exceeds(c, level), tree.get_smallest_neighbor_level(c) > level);
+  };
+
+  typedef mjr::MR_rect_tree<9, double, 1, 1> t1_t;
+  t1_t tree1;
+  tree1.refine_grid(1, [](t1_t::drpt_t x) { return x; });
+  tree1.refine_leaves_recursive_cell_pred(8, [](t1_t::drpt_t x) { return x; }, [&tree1](t1_t::diti_t c) { return tree1.diti_to_drpt(c) < 0.1; });
+  check(tree1, 8);
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> t2_t;
+  auto f2 = [](t2_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+  t2_t tree2({-1.0, -1.0}, {1.0, 1.0});
+  tree2.refine_grid(1, f2);
+  tree2.refine_leaves_recursive_cell_pred(6, f2, [&tree2](t2_t::diti_t c) { return tree2.cell_cross_range_level(c, 0, 0.0); });
+  check(tree2, 5);
+  tree2.balance_tree(1, f2);
+  for(auto c: tree2.get_leaf_cells())
+    EXPECT_FALSE(tree2.cell_is_unbalanced(1, c));
+
+  typedef mjr::MR_rect_tree<5, double, 3, 1> t3_t;
+  auto f3 = [](t3_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+  t3_t tree3;
+  tree3.refine_grid(1, f3);
+  tree3.refine_leaves_recursive_cell_pred(4, f3, [&tree3](t3_t::diti_t c) { return tree3.cell_cross_range_level(c, 0, 0.0); });
+  check(tree3, 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_neighbors, balance) {
+// What we are testing:
+//   - balance_tree() produces the same samples as repeated refine_leaves_atomically_if_cell_pred() passes (2D & 3D, several deltas)
+//   - With set_balance_delta(), the scalar predicate refiners leave a balanced tree
+//   - With set_balance_delta(), refine_leaves_recursive_cell_pred() only calls func on the calling thread
+
+  auto check = [](auto tree, int delta, auto f) {
+    auto tree2 = tree;
+    tree.balance_tree(delta, f);
+    tree2.refine_leaves_atomically_if_cell_pred(-1, f, [&tree2, delta](auto c) { return tree2.cell_is_unbalanced(delta, c); });
+    EXPECT_EQ(tree.get_sample_count(), tree2.get_sample_count());
+    for(auto itr=tree2.cbegin_samples(); itr!=tree2.cend_samples(); ++itr)
+      EXPECT_TRUE(tree.vertex_exists(itr->first));
+    for(auto c: tree.get_leaf_cells())
+      EXPECT_FALSE(tree.cell_is_unbalanced(delta, c));
+  };
+
+  typedef mjr::MR_rect_tree<9, double, 2, 1> t2_t;
+  auto f2 = [](t2_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+  t2_t tree2({-1.0, -1.0}, {1.0, 1.0});
+  tree2.refine_grid(1, f2);
+  tree2.refine_leaves_recursive_cell_pred(8, f2, [&tree2](t2_t::diti_t c) { return tree2.cell_cross_range_level(c, 0, 0.0); });
+  for(int delta=0; delta<3; delta++)
+    check(tree2, delta, f2);
+
+  typedef mjr::MR_rect_tree<6, double, 3, 1> t3_t;
+  auto f3 = [](t3_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+  t3_t tree3;
+  tree3.refine_grid(1, f3);
+  tree3.refine_leaves_recursive_cell_pred(5, f3, [&tree3](t3_t::diti_t c) { return tree3.cell_cross_range_level(c, 0, 0.0); });
+  for(int delta=0; delta<3; delta++)
+    check(tree3, delta, f3);
+
+  std::atomic<int> other_thread_calls = 0;
+  auto f2m = [&other_thread_calls, &f2, main_id=std::this_thread::get_id()](t2_t::drpt_t x) {
+    if (std::this_thread::get_id() != main_id)
+      other_thread_calls++;
+    return f2(x);
+  };
+  for(int delta=0; delta<3; delta++) {
+    t2_t tree2a({-1.0, -1.0}, {1.0, 1.0});
+    tree2a.set_balance_delta(delta);
+    EXPECT_EQ(tree2a.get_balance_delta(), delta);
+    tree2a.refine_grid(1, f2);
+    tree2a.set_thread_count(4);
+    tree2a.refine_leaves_recursive_cell_pred(8, f2m, [&tree2a](t2_t::diti_t c) { return tree2a.cell_cross_range_level(c, 0, 0.0); });
+    EXPECT_EQ(other_thread_calls, 0);
+    for(auto c: tree2a.get_leaf_cells())
+      EXPECT_FALSE(tree2a.cell_is_unbalanced(delta, c));
+    tree2a.refine_leaves_atomically_if_cell_pred(8, f2, [&tree2a](t2_t::diti_t c) { return tree2a.diti_to_drpt(c)[0] > 0.9; });
+    for(auto c: tree2a.get_leaf_cells())
+      EXPECT_FALSE(tree2a.cell_is_unbalanced(delta, c));
+  }
+}
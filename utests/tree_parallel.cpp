@@ -0,0 +1,216 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_parallel.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree multithreaded sampling.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+#include <gtest/gtest.h>
+#include <numeric>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, grid) {
+// What we are testing:
+//   - refine_grid with several threads produces exactly the same tree as with one thread -- including sample order
+//   - Grids larger than one tile work
+
+  typedef mjr::MR_rect_tree<10, double, 2, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return std::sin(x[0]*x[1]); };
+
+  tt_t tree_s;
+  tree_s.refine_grid(9, f);
+
+  tt_t tree_p;
+  tree_p.set_thread_count(4);
+  EXPECT_EQ(tree_p.get_thread_count(), 4);
+  tree_p.refine_grid(9, f);
+
+  EXPECT_EQ(tree_s.get_sample_count(), tree_p.get_sample_count());
+  EXPECT_EQ(tree_s.get_sample_count(), 513u*513u+512u*512u);  // vertexes + centers
+
+  auto itr_p = tree_p.cbegin_samples();
+  for(auto itr_s=tree_s.cbegin_samples(); itr_s!=tree_s.cend_samples(); ++itr_s, ++itr_p) {
+    ASSERT_EQ(itr_s->first,  itr_p->first);
+    ASSERT_EQ(itr_s->second, itr_p->second);
+  }
+
+  tree_p.set_thread_count(0);
+  EXPECT_GE(tree_p.get_thread_count(), 1);
+  tree_p.set_thread_count(-3);
+  EXPECT_EQ(tree_p.get_thread_count(), 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, cell) {
+// What we are testing:
+//   - refine_grid on a sub-cell with several threads matches one thread
+
+  typedef mjr::MR_rect_tree<5, double, 3, 2> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return tt_t::rrpt_t({x[0]+x[1]*x[2], x[0]*x[1]-x[2]}); };
+
+  tt_t tree_s, tree_p;
+  tree_p.set_thread_count(3);
+  auto cell = tree_s.ccc_get_children(tree_s.ccc_get_top_cell())[5];
+  tree_s.refine_grid(cell, 3, f);
+  tree_p.refine_grid(cell, 3, f);
+
+  EXPECT_EQ(tree_s.get_sample_count(), tree_p.get_sample_count());
+  for(auto itr=tree_s.cbegin_samples(); itr!=tree_s.cend_samples(); ++itr) {
+    ASSERT_TRUE(tree_p.vertex_exists(itr->first));
+    EXPECT_EQ(tree_p.get_sample(itr->first), itr->second);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, leaves) {
+// What we are testing:
+//   - refine_leaves_once_if_cell_pred is identical to calling refine_once on each selected leaf -- including sample order
+//   - refine_leaves_atomically_if_cell_pred & balance_tree with several threads are identical to one thread
+
+  typedef mjr::MR_rect_tree<9, double, 2, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree_r, tree_s, tree_p;
+  tree_p.set_thread_count(4);
+  for(tt_t* t: {&tree_r, &tree_s, &tree_p})
+    t->refine_grid(4, f);
+
+  auto cross = [](tt_t& t) { return [&t](tt_t::diti_t c) { return t.cell_cross_range_level(c, 0, 0.0); }; };
+
+  int num_refined = 0;
+  for(auto c: tree_r.get_leaf_cells(tree_r.ccc_get_top_cell()))
+    if (tree_r.cell_cross_range_level(c, 0, 0.0))
+      num_refined += tree_r.refine_once(c, f);
+  EXPECT_EQ(tree_s.refine_leaves_once_if_cell_pred(-1, f, cross(tree_s)), num_refined);
+  EXPECT_EQ(tree_p.refine_leaves_once_if_cell_pred(-1, f, cross(tree_p)), num_refined);
+
+  tree_s.refine_leaves_atomically_if_cell_pred(8, f, cross(tree_s));
+  tree_p.refine_leaves_atomically_if_cell_pred(8, f, cross(tree_p));
+  tree_r.refine_leaves_atomically_if_cell_pred(8, f, cross(tree_r));
+  tree_s.balance_tree(1, f);
+  tree_p.balance_tree(1, f);
+  tree_r.balance_tree(1, f);
+
+  EXPECT_GT(tree_s.get_sample_count(), 0u);
+  EXPECT_EQ(tree_s.get_sample_count(), tree_p.get_sample_count());
+  EXPECT_EQ(tree_s.get_sample_count(), tree_r.get_sample_count());
+  auto itr_p = tree_p.cbegin_samples();
+  auto itr_r = tree_r.cbegin_samples();
+  for(auto itr_s=tree_s.cbegin_samples(); itr_s!=tree_s.cend_samples(); ++itr_s, ++itr_p, ++itr_r) {
+    ASSERT_EQ(itr_s->first,  itr_p->first);
+    ASSERT_EQ(itr_s->second, itr_p->second);
+    ASSERT_EQ(itr_s->first,  itr_r->first);
+  }
+  EXPECT_EQ(tree_s.get_leaf_cells(), tree_p.get_leaf_cells());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, sharded_once) {
+// What we are testing:
+//   - MR_sharded_map::try_emplace_with computes each value exactly once when many threads race for the same keys
+
+  mjr::MR_sharded_map<uint64_t, uint64_t> smap;
+  std::atomic<int> num_calls = 0;
+  {
+    std::vector<std::jthread> threads;
+    for(int t=0; t<8; t++)
+      threads.emplace_back([&smap, &num_calls]() {
+                             for(uint64_t key=0; key<2000; key++) {
+                               auto [v, is_new] = smap.try_emplace_with(key, [&num_calls, key]() { num_calls++; return key*key; });
+                               EXPECT_EQ(v, key*key);
+                             }
+                           });
+  }
+  EXPECT_EQ(num_calls, 2000);
+  EXPECT_EQ(smap.size(), 2000u);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, recursive) {
+// What we are testing:
+//   - refine_recursive_cell_pred_parallel gives the same samples as refine_recursive_cell_pred
+//   - No vertex is sampled more than once, and per-thread sample counts add up
+
+  typedef mjr::MR_rect_tree<9, double, 3, 1>                       ft_t;
+  typedef mjr::MR_rect_tree<9, double, 3, 1, mjr::MR_sharded_map>  st_t;
+
+  std::atomic<std::size_t> num_calls = 0;
+  auto f  = [](ft_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+  auto cf = [&num_calls, &f](ft_t::drpt_t x) { num_calls++; return f(x); };
+
+  ft_t ftree;
+  st_t stree;
+  stree.set_thread_count(4);
+
+  ftree.refine_grid(1, f);
+  stree.refine_grid(1, f);
+  num_calls = 0;
+  ftree.refine_recursive_cell_pred(ftree.ccc_get_top_cell(), 6, f, [&ftree](ft_t::diti_t c) { return ftree.cell_cross_range_level(c, 0, 0.0); });
+  auto counts = stree.refine_recursive_cell_pred_parallel(stree.ccc_get_top_cell(), 6, cf, [&stree](st_t::diti_t c) { return stree.cell_cross_range_level(c, 0, 0.0); });
+
+  EXPECT_GT(ftree.get_sample_count(), 1000u);
+  EXPECT_EQ(ftree.get_sample_count(), stree.get_sample_count());
+  EXPECT_EQ(num_calls + 35, stree.get_sample_count());  // refine_grid(1) sampled 27 corners + 8 centers
+  EXPECT_EQ(counts.size(), 4u);
+  EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), std::size_t(0)), num_calls);
+  for(auto itr=ftree.cbegin_samples(); itr!=ftree.cend_samples(); ++itr) {
+    ASSERT_TRUE(stree.vertex_exists(itr->first));
+    EXPECT_EQ(stree.get_sample(itr->first), itr->second);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_parallel, leaves_recursive) {
+// What we are testing:
+//   - refine_leaves_recursive_cell_pred_parallel on a very unbalanced tree gives the same samples as refine_leaves_recursive_cell_pred
+//   - One thread falls back to the serial algorithm
+
+  typedef mjr::MR_rect_tree<12, double, 2, 1, mjr::MR_sharded_map>  st_t;
+
+  auto f = [](st_t::drpt_t x) { return x[0]*x[0]*x[1]+x[1]*x[1]*x[0]-0.1; };
+
+  st_t stree, otree;
+  stree.set_thread_count(6);
+
+  for(auto t: {&stree, &otree})
+    t->refine_grid(2, f);
+  auto counts = stree.refine_leaves_recursive_cell_pred_parallel(11, f, [&stree](st_t::diti_t c) { return stree.cell_cross_range_level(c, 0, 0.0); });
+  auto ocount = otree.refine_leaves_recursive_cell_pred_parallel(11, f, [&otree](st_t::diti_t c) { return otree.cell_cross_range_level(c, 0, 0.0); });
+
+  EXPECT_EQ(counts.size(), 6u);
+  EXPECT_EQ(ocount.size(), 1u);
+  EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), std::size_t(0)), ocount[0]);
+  EXPECT_EQ(stree.get_sample_count(), otree.get_sample_count());
+  EXPECT_EQ(stree.get_leaf_cells(), otree.get_leaf_cells());
+  for(auto itr=otree.cbegin_samples(); itr!=otree.cend_samples(); ++itr)
+    EXPECT_EQ(stree.get_sample(itr->first), itr->second);
+}
@@ -0,0 +1,488 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_sample_store.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree sample stores.@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+#include <gtest/gtest.h>
+#include <unordered_map>
+#include "MR_rect_tree.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, flat_map) {
+// What we are testing:
+//   - MR_flat_map contents match std::unordered_map after inserts, overwrites, & erases
+//   - Iteration visits every element exactly once
+//   - at() throws for missing keys
+
+  mjr::MR_flat_map<uint64_t, double>      fmap;
+  std::unordered_map<uint64_t, double>    umap;
+
+  uint64_t x = 12345;
+  for(int i=0; i<20000; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t k = (x >> 40) << 4;  // Lots of trailing zeros & repeated keys
+    fmap.insert_or_assign(k, static_cast<double>(i));
+    umap.insert_or_assign(k, static_cast<double>(i));
+    if ((i % 7) == 0) {
+      EXPECT_EQ(fmap.erase(k), umap.erase(k));
+    }
+  }
+
+  EXPECT_EQ(fmap.size(), umap.size());
+  EXPECT_LE(fmap.load_factor(), fmap.max_load_factor());
+
+  std::size_t num_visited = 0;
+  for(const auto& kvp : fmap) {
+    EXPECT_TRUE(umap.contains(kvp.first));
+    EXPECT_EQ(umap.at(kvp.first), kvp.second);
+    num_visited++;
+  }
+  EXPECT_EQ(num_visited, umap.size());
+
+  for(const auto& kvp : umap) {
+    EXPECT_TRUE(fmap.contains(kvp.first));
+    EXPECT_EQ(fmap.at(kvp.first), kvp.second);
+  }
+
+  EXPECT_FALSE(fmap.contains(3));
+  EXPECT_THROW(fmap.at(3), std::out_of_range);
+
+  fmap[3] = 1.5;
+  EXPECT_EQ(fmap.at(3), 1.5);
+
+  fmap.clear();
+  EXPECT_EQ(fmap.size(), 0);
+  EXPECT_FALSE(fmap.contains(3));
+  EXPECT_EQ(fmap.cbegin(), fmap.cend());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, tree_stores) {
+// What we are testing:
+//   - Trees using MR_flat_map & std::unordered_map contain identical samples and leaves after uniform & adaptive refinement
+
+  typedef mjr::MR_rect_tree<15, double, 2, 2>                            ft_t;
+  typedef mjr::MR_rect_tree<15, double, 2, 2, mjr::MR_std_unordered_map> ut_t;
+
+  auto f = [](ft_t::drpt_t x) { return ft_t::rrpt_t({std::sin(3*x[0])*std::cos(2*x[1]), x[0]*x[1]}); };
+
+  ft_t ftree;
+  ut_t utree;
+
+  ftree.refine_grid(3, f);
+  utree.refine_grid(3, f);
+  ftree.refine_leaves_recursive_cell_pred(7, f, [&ftree](ft_t::diti_t c) { return ftree.cell_cross_range_level(c, 0, 0.25); });
+  utree.refine_leaves_recursive_cell_pred(7, f, [&utree](ut_t::diti_t c) { return utree.cell_cross_range_level(c, 0, 0.25); });
+
+  EXPECT_EQ(ftree.get_sample_count(), utree.get_sample_count());
+  for(auto itr=utree.cbegin_samples(); itr!=utree.cend_samples(); ++itr) {
+    EXPECT_TRUE(ftree.vertex_exists(itr->first));
+    EXPECT_EQ(ftree.get_sample(itr->first), itr->second);
+  }
+
+  EXPECT_EQ(ftree.get_leaf_cells(), utree.get_leaf_cells());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, diti_hash) {
+// What we are testing:
+//   - sample_store_histogram() accounts for every sample for both store types
+//   - MR_diti_hash spreads a regular grid of samples across MR_flat_map (short mean probe length)
+
+  typedef mjr::MR_rect_tree<15, double, 2, 1>                            ft_t;
+  typedef mjr::MR_rect_tree<15, double, 2, 1, mjr::MR_std_unordered_map> ut_t;
+
+  ft_t ftree;
+  ut_t utree;
+
+  ftree.refine_grid(8, [](ft_t::drpt_t x) { return x[0]+x[1]; });
+  utree.refine_grid(8, [](ut_t::drpt_t x) { return x[0]+x[1]; });
+
+  std::vector<std::size_t> fcounts = ftree.sample_store_histogram();
+  std::size_t fsum = 0;
+  std::size_t fprobe = 0;
+  for(std::size_t i=0; i<fcounts.size(); i++) {
+    fsum   += fcounts[i];
+    fprobe += i*fcounts[i];
+  }
+  EXPECT_EQ(fsum, ftree.get_sample_count());
+  EXPECT_LT(static_cast<double>(fprobe) / static_cast<double>(fsum), 1.0);
+
+  std::vector<std::size_t> ucounts = utree.sample_store_histogram();
+  std::size_t usum = 0;
+  for(std::size_t i=0; i<ucounts.size(); i++)
+    usum += i*ucounts[i];
+  EXPECT_EQ(usum, utree.get_sample_count());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, soa_map) {
+// What we are testing:
+//   - MR_soa_map insert, replace, lookup, erase, & columns stay consistent with std::unordered_map
+
+  typedef std::array<double, 3> val_t;
+  mjr::MR_soa_map<uint64_t, val_t>     smap;
+  std::unordered_map<uint64_t, val_t>  umap;
+
+  uint64_t k = 17;
+  for(int i=0; i<5000; i++) {
+    k = k * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t key = (k >> 40) << 2;
+    val_t val = {static_cast<double>(i), static_cast<double>(key), -static_cast<double>(i)};
+    smap.insert_or_assign(key, val);
+    umap.insert_or_assign(key, val);
+    if ((i % 5) == 0) {
+      smap.erase(key);
+      umap.erase(key);
+    }
+  }
+
+  EXPECT_EQ(smap.size(), umap.size());
+  EXPECT_EQ(smap.column(1).size(), umap.size());
+  EXPECT_EQ(smap.key_column().size(), umap.size());
+
+  for(const auto& kvp : umap) {
+    EXPECT_TRUE(smap.contains(kvp.first));
+    EXPECT_EQ(smap.at(kvp.first), kvp.second);
+    EXPECT_EQ(smap.component_at(kvp.first, 2), kvp.second[2]);
+  }
+
+  std::size_t num_visited = 0;
+  for(auto itr=smap.cbegin(); itr!=smap.cend(); ++itr) {
+    EXPECT_EQ(umap.at(itr->first), itr->second);
+    EXPECT_EQ(smap.key_column()[num_visited], itr->first);
+    EXPECT_EQ(smap.column(1)[num_visited], itr->second[1]);
+    num_visited++;
+  }
+  EXPECT_EQ(num_visited, umap.size());
+
+  EXPECT_FALSE(smap.contains(3));
+  EXPECT_THROW(smap.at(3), std::out_of_range);
+  EXPECT_EQ(smap.erase(3), 0);
+
+  smap.clear();
+  EXPECT_EQ(smap.size(), 0);
+  EXPECT_EQ(smap.cbegin(), smap.cend());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, sharded_map) {
+// What we are testing:
+//   - MR_sharded_map insert, replace, lookup, erase, & iteration stay consistent with std::unordered_map
+//   - insert_or_assign reports new keys like std::unordered_map
+//   - try_emplace_with only computes missing values
+//   - Copies are independent
+
+  mjr::MR_sharded_map<uint64_t, double> smap;
+  std::unordered_map<uint64_t, double>  umap;
+
+  smap.reserve(5000);
+  uint64_t k = 17;
+  for(int i=0; i<5000; i++) {
+    k = k * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t key = (k >> 40) << 2;
+    auto [selt, snew] = smap.insert_or_assign(key, i);
+    auto [uitr, unew] = umap.insert_or_assign(key, i);
+    EXPECT_EQ(snew, unew);
+    EXPECT_EQ(selt.second, uitr->second);
+    if ((i % 5) == 0) {
+      smap.erase(key);
+      umap.erase(key);
+    }
+  }
+
+  EXPECT_EQ(smap.size(), umap.size());
+  for(const auto& kvp : umap) {
+    EXPECT_TRUE(smap.contains(kvp.first));
+    EXPECT_EQ(smap.at(kvp.first), kvp.second);
+  }
+
+  std::size_t num_visited = 0;
+  for(auto itr=smap.cbegin(); itr!=smap.cend(); ++itr) {
+    EXPECT_EQ(umap.at(itr->first), itr->second);
+    num_visited++;
+  }
+  EXPECT_EQ(num_visited, umap.size());
+
+  auto [v1, new1] = smap.try_emplace_with(umap.begin()->first, []() { return -1.0; });
+  EXPECT_FALSE(new1);
+  EXPECT_EQ(v1, umap.begin()->second);
+  auto [v2, new2] = smap.try_emplace_with(3, []() { return -1.0; });
+  EXPECT_TRUE(new2);
+  EXPECT_EQ(v2, -1.0);
+  EXPECT_EQ(smap.at(3), -1.0);
+
+  mjr::MR_sharded_map<uint64_t, double> cmap(smap);
+  EXPECT_EQ(smap.erase(3), 1);
+  EXPECT_FALSE(smap.contains(3));
+  EXPECT_THROW(smap.at(3), std::out_of_range);
+  EXPECT_EQ(smap.erase(3), 0);
+  EXPECT_TRUE(cmap.contains(3));
+  EXPECT_EQ(cmap.size(), smap.size()+1);
+
+  smap.clear();
+  EXPECT_EQ(smap.size(), 0);
+  EXPECT_EQ(smap.cbegin(), smap.cend());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, soa_tree) {
+// What we are testing:
+//   - A tree using MR_soa_map matches one using MR_flat_map
+//   - Single component accessors & scans agree between column and row stores
+
+  typedef mjr::MR_rect_tree<15, double, 2, 3>                  ft_t;
+  typedef mjr::MR_rect_tree<15, double, 2, 3, mjr::MR_soa_map> st_t;
+
+  auto f = [](ft_t::drpt_t x) { return ft_t::rrpt_t({x[0]*x[0]+x[1]*x[1], (x[0] > 0.5 ? std::nan("") : x[0]), 2*x[1]}); };
+
+  ft_t ftree;
+  st_t stree;
+
+  ftree.refine_grid(4, f);
+  stree.refine_grid(4, f);
+  ftree.refine_leaves_recursive_cell_pred(7, f, [&ftree](ft_t::diti_t c) { return ftree.cell_cross_range_level(c, 0, 0.5); });
+  stree.refine_leaves_recursive_cell_pred(7, f, [&stree](st_t::diti_t c) { return stree.cell_cross_range_level(c, 0, 0.5); });
+
+  EXPECT_EQ(ftree.get_sample_count(), stree.get_sample_count());
+  EXPECT_EQ(ftree.get_leaf_cells(), stree.get_leaf_cells());
+
+  for(auto itr=ftree.cbegin_samples(); itr!=ftree.cend_samples(); ++itr) {
+    EXPECT_TRUE(stree.vertex_exists(itr->first));
+    EXPECT_EQ(stree.get_sample_component(itr->first, 2), itr->second[2]);
+  }
+
+  for(int i=0; i<3; i++) {
+    EXPECT_EQ(ftree.get_sample_component_min(i),    stree.get_sample_component_min(i));
+    EXPECT_EQ(ftree.get_sample_component_max(i),    stree.get_sample_component_max(i));
+    EXPECT_EQ(ftree.count_nan_sample_components(i), stree.count_nan_sample_components(i));
+  }
+  EXPECT_DOUBLE_EQ(stree.get_sample_component_min(0), 0.0);
+  EXPECT_DOUBLE_EQ(stree.get_sample_component_max(1), 0.5);
+  EXPECT_GT(stree.count_nan_samples(), 0);
+  EXPECT_EQ(ftree.count_nan_samples(), stree.count_nan_samples());
+  EXPECT_EQ(stree.count_nan_samples(), stree.count_nan_sample_components(1));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, mixed_precision) {
+// What we are testing:
+//   - Range values stored as float are the float rounding of the double sample function values
+//   - Domain computation stays in double
+//   - Row & column stores behave the same with float range storage
+
+  typedef mjr::MR_rect_tree<15, double, 2, 3>                         dt_t;
+  typedef mjr::MR_rect_tree<15, double, 2, 3, mjr::MR_flat_map, float> ft_t;
+  typedef mjr::MR_rect_tree<15, double, 2, 3, mjr::MR_soa_map,  float> st_t;
+
+  EXPECT_EQ(sizeof(ft_t::srpt_t), 3*sizeof(float));
+  EXPECT_TRUE((std::is_same<ft_t::rrpt_t, dt_t::rrpt_t>::value));
+  EXPECT_TRUE((std::is_same<dt_t::srpt_t, dt_t::rrpt_t>::value));
+
+  auto f = [](dt_t::drpt_t x) { return dt_t::rrpt_t({std::sin(x[0])+0.1, x[0]*x[1]/3.0, x[1]}); };
+
+  dt_t dtree;
+  ft_t ftree;
+  st_t stree;
+
+  dtree.refine_grid(5, f);
+  ftree.refine_grid(5, f);
+  stree.refine_grid(5, f);
+
+  EXPECT_EQ(ftree.get_sample_count(), dtree.get_sample_count());
+  EXPECT_EQ(stree.get_sample_count(), dtree.get_sample_count());
+
+  for(auto itr=dtree.cbegin_samples(); itr!=dtree.cend_samples(); ++itr) {
+    EXPECT_EQ(ftree.diti_to_drpt(itr->first), dtree.diti_to_drpt(itr->first));
+    ft_t::rrpt_t fv = ftree.get_sample(itr->first);
+    ft_t::rrpt_t sv = stree.get_sample(itr->first);
+    for(int i=0; i<3; i++) {
+      EXPECT_EQ(fv[i], static_cast<double>(static_cast<float>(itr->second[i])));
+      EXPECT_EQ(sv[i], fv[i]);
+      EXPECT_EQ(stree.get_sample_component(itr->first, i), fv[i]);
+    }
+  }
+
+  EXPECT_EQ(ftree.get_sample_component_max(2), 1.0);
+  EXPECT_EQ(stree.get_sample_component_min(2), -1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, sorted_map) {
+// What we are testing:
+//   - MR_sorted_map built from an unordered range finds every key, rejects missing keys, & iterates in key order
+
+  std::unordered_map<uint64_t, double> umap;
+  uint64_t k = 3;
+  for(int i=0; i<7000; i++) {
+    k = k * 6364136223846793005ULL + 1442695040888963407ULL;
+    umap.insert_or_assign((k >> 30) << 1, static_cast<double>(i));
+  }
+  umap.insert_or_assign(0, -1.0);
+
+  mjr::MR_sorted_map<uint64_t, double> smap(umap.cbegin(), umap.cend());
+
+  EXPECT_EQ(smap.size(), umap.size());
+  for(const auto& kvp : umap) {
+    EXPECT_TRUE(smap.contains(kvp.first));
+    EXPECT_EQ(smap.at(kvp.first), kvp.second);
+    EXPECT_FALSE(smap.contains(kvp.first+1));
+  }
+
+  uint64_t last_key = 0;
+  std::size_t num_visited = 0;
+  for(auto itr=smap.cbegin(); itr!=smap.cend(); ++itr) {
+    if (num_visited > 0) {
+      EXPECT_LT(last_key, itr->first);
+    }
+    last_key = itr->first;
+    num_visited++;
+  }
+  EXPECT_EQ(num_visited, umap.size());
+
+  EXPECT_FALSE(smap.contains(last_key+2));
+  EXPECT_FALSE(smap.contains(~static_cast<uint64_t>(0)));
+  EXPECT_THROW(smap.at(1), std::out_of_range);
+  EXPECT_EQ(smap.find(1), smap.cend());
+
+  mjr::MR_sorted_map<uint64_t, double> emap;
+  EXPECT_FALSE(emap.contains(0));
+  EXPECT_EQ(emap.cbegin(), emap.cend());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, freeze) {
+// What we are testing:
+//   - A frozen tree answers sample, cell, leaf, & neighbor queries exactly like the original
+
+  typedef mjr::MR_rect_tree<15, double, 3, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]+x[2]*x[2]-0.5; };
+
+  tt_t tree;
+  tree.refine_grid(2, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+
+  const tt_t::frozen_t ftree = tree.freeze();
+
+  EXPECT_EQ(ftree.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(ftree.get_bbox_min(),     tree.get_bbox_min());
+  EXPECT_EQ(ftree.get_bbox_max(),     tree.get_bbox_max());
+
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr) {
+    EXPECT_TRUE(ftree.vertex_exists(itr->first));
+    EXPECT_EQ(ftree.get_sample(itr->first), itr->second);
+  }
+
+  tt_t::diti_list_t leaves = tree.get_leaf_cells();
+  EXPECT_EQ(ftree.get_leaf_cells(), leaves);
+  EXPECT_EQ(ftree.count_leaf_cells(ftree.ccc_get_top_cell()), tree.count_leaf_cells(tree.ccc_get_top_cell()));
+
+  for(auto c: leaves) {
+    EXPECT_EQ(ftree.cell_has_child(c), tree.cell_has_child(c));
+    EXPECT_EQ(ftree.cell_cross_range_level(c, 0, 0.0), tree.cell_cross_range_level(c, 0, 0.0));
+    for(auto v: tree.ccc_get_vertexes(c))
+      EXPECT_EQ(ftree.vertex_exists(v), tree.vertex_exists(v));
+    for(int i=0; i<3; i++)
+      for(int d=-1; d<2; d+=2)
+        EXPECT_EQ(ftree.get_existing_neighbor(c, i, d), tree.get_existing_neighbor(c, i, d));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_sample_store, bricks) {
+// What we are testing:
+//   - pack_bricks moves uniformly refined regions into bricks without changing any query
+//   - Sampling works across bricks, and finer samples go to the sample store
+//   - unpack_bricks restores the original store
+
+  typedef mjr::MR_rect_tree<10, double, 2, 1> tt_t;
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+  auto g = [](tt_t::drpt_t x) { return x[0]-x[1]; };
+
+  tt_t tree;
+  tree.refine_grid(4, f);
+  tree.refine_leaves_recursive_cell_pred(7, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+
+  tt_t ref = tree;
+
+  EXPECT_EQ(tree.pack_bricks(10, 0),  0);  // Invalid level
+  EXPECT_EQ(tree.pack_bricks(3,  7),  0);  // Too deep
+  EXPECT_EQ(tree.pack_bricks(2,  2), 16);  // Every level 2 cell is fully refined to level 4
+  EXPECT_EQ(tree.get_brick_count(),  16);
+  EXPECT_GT(tree.get_brick_sample_count(), 0u);
+  EXPECT_LT(tree.get_brick_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(tree.get_sample_count(), ref.get_sample_count());
+
+  std::size_t num_visited = 0;
+  std::set<tt_t::diti_t> visited;
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr) {
+    EXPECT_TRUE(ref.vertex_exists(itr->first));
+    EXPECT_EQ(ref.get_sample(itr->first), itr->second);
+    visited.insert(itr->first);
+    num_visited++;
+  }
+  EXPECT_EQ(num_visited, ref.get_sample_count());
+  EXPECT_EQ(visited.size(), ref.get_sample_count());
+
+  for(tt_t::dic_t x=0; x<=tt_t::dic_max; x+=4) {
+    for(tt_t::dic_t y=0; y<=tt_t::dic_max; y+=4) {
+      tt_t::diti_t v = tree.dita_to_diti({x, y, 0});
+      EXPECT_EQ(tree.vertex_exists(v), ref.vertex_exists(v));
+      if (ref.vertex_exists(v)) {
+        EXPECT_EQ(tree.get_sample(v), ref.get_sample(v));
+      }
+    }
+  }
+
+  EXPECT_EQ(tree.get_leaf_cells(), ref.get_leaf_cells());
+  EXPECT_EQ(tree.get_sample_component_min(0), ref.get_sample_component_min(0));
+  EXPECT_EQ(tree.count_nan_samples(), ref.count_nan_samples());
+
+  // Resample a point on a face shared by four bricks, and a finer point
+  tt_t::diti_t shared = tree.dita_to_diti({tt_t::dic_max/4, tt_t::dic_max/2, 0});
+  tree.sample_point(shared, g);
+  ref.sample_point(shared, g);
+  EXPECT_EQ(tree.get_sample(shared), ref.get_sample(shared));
+  tree.refine_leaves_once_if_cell_pred(8, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+  ref.refine_leaves_once_if_cell_pred(8, f,  [&ref](tt_t::diti_t c)  { return ref.cell_cross_range_level(c, 0, 0.0); });
+  EXPECT_EQ(tree.get_sample_count(), ref.get_sample_count());
+  EXPECT_EQ(tree.get_leaf_cells(), ref.get_leaf_cells());
+
+  tt_t::frozen_t ftree = tree.freeze();
+  EXPECT_EQ(ftree.get_sample_count(), ref.get_sample_count());
+
+  tree.unpack_bricks();
+  EXPECT_EQ(tree.get_brick_count(), 0);
+  EXPECT_EQ(tree.get_sample_count(), ref.get_sample_count());
+  for(auto itr=ref.cbegin_samples(); itr!=ref.cend_samples(); ++itr)
+    EXPECT_EQ(tree.get_sample(itr->first), itr->second);
+}
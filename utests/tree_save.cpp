@@ -0,0 +1,191 @@
+// -*- Mode:C++; Coding:us-ascii-unix; fill-column:158 -*-
+/*******************************************************************************************************************************************************.H.S.**/
+/**
+ @file      tree_save.cpp
+ @author    Mitch Richling http://www.mitchr.me/
+ @date      2026-10-16
+ @brief     Unit tests for MR_rect_tree save() & load().@EOL
+ @std       C++23
+ @copyright 
+  @parblock
+  Copyright (c) 2026, Mitchell Jay Richling <http://www.mitchr.me/> All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this list of conditions, and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions, and the following disclaimer in the documentation
+     and/or other materials provided with the distribution.
+
+  3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived from this software
+     without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+  OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+  DAMAGE.
+  @endparblock
+*/
+/*******************************************************************************************************************************************************.H.E.**/
+
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include "MR_rect_tree.hpp"
+#include "MR_mapped_map.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_save, round_trip) {
+// What we are testing:
+//   - load() restores the bounding box & samples exactly
+//   - Samples in dense bricks are saved
+//   - A saved tree may be loaded into a frozen tree
+
+  typedef mjr::MR_rect_tree<7, double, 2, 2> tt_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_save_round_trip.mrpt").string();
+
+  auto f = [](tt_t::drpt_t x) { return tt_t::rrpt_t({std::sin(x[0]*x[1]), x[0]/3.0-x[1]}); };
+  auto c = [](tt_t::drpt_t x) { return (x[0]*x[0]+x[1]*x[1] < 0.5); };
+
+  tt_t tree({-1.5, -0.5}, {2.5, 3.5});
+  tree.refine_grid(3, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree, &c](tt_t::diti_t cell) { return c(tree.diti_to_drpt(cell)); });
+  EXPECT_GT(tree.pack_bricks(1, 2), 0);
+  EXPECT_EQ(tree.save(file_name), 0);
+  EXPECT_EQ(std::filesystem::file_size(file_name), tt_t::save_val_offset(tree.get_sample_count()) + tree.get_sample_count() * sizeof(tt_t::srpt_t));
+
+  tt_t tree2;
+  tree2.refine_grid(2, f);
+  EXPECT_EQ(tree2.load(file_name), 0);
+  EXPECT_EQ(tree2.get_bbox_min(), tree.get_bbox_min());
+  EXPECT_EQ(tree2.get_bbox_max(), tree.get_bbox_max());
+  EXPECT_EQ(tree2.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(tree2.get_brick_count(), 0);
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(tree2.get_sample(itr->first), itr->second);
+
+  tt_t::frozen_t ftree;
+  EXPECT_EQ(ftree.load(file_name), 0);
+  EXPECT_EQ(ftree.get_sample_count(), tree.get_sample_count());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr)
+    EXPECT_EQ(ftree.get_sample(itr->first), itr->second);
+
+  std::filesystem::remove(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_save, view) {
+// What we are testing:
+//   - A view answers sample, cell, leaf, & neighbor queries exactly like the saved tree
+//   - Values after padding are found when keys are smaller than values (uint16_t keys & double values)
+//   - Copies of a view share the mapping, and outlive the original
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+  typedef mjr::MR_rect_tree_view<7, double, 2, 1> vt_t;
+
+  static_assert(std::is_same<vt_t, tt_t::view_t>::value);
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_save_view.mrpt").string();
+
+  auto f = [](tt_t::drpt_t x) { return x[0]*x[0]+x[1]*x[1]-0.5; };
+
+  tt_t tree({-1.0, -1.0}, {1.0, 1.0});
+  tree.refine_grid(2, f);
+  tree.refine_leaves_recursive_cell_pred(6, f, [&tree](tt_t::diti_t c) { return tree.cell_cross_range_level(c, 0, 0.0); });
+  if (tree.get_sample_count() % 2 == 0)
+    tree.sample_point(tree.dita_to_diti({1, 1}), f);  // Odd count so the values need padding
+  EXPECT_EQ(tree.save(file_name), 0);
+
+  vt_t view;
+  EXPECT_EQ(view.load(file_name), 0);
+  vt_t cview = view;
+  view = vt_t();
+  EXPECT_EQ(view.get_sample_count(), 0u);
+
+  EXPECT_EQ(cview.get_sample_count(), tree.get_sample_count());
+  EXPECT_EQ(cview.get_bbox_min(),     tree.get_bbox_min());
+  EXPECT_EQ(cview.get_bbox_max(),     tree.get_bbox_max());
+  for(auto itr=tree.cbegin_samples(); itr!=tree.cend_samples(); ++itr) {
+    EXPECT_TRUE(cview.vertex_exists(itr->first));
+    EXPECT_EQ(cview.get_sample(itr->first), itr->second);
+  }
+  tt_t::diti_t prev = 0;
+  for(auto itr=cview.cbegin_samples(); itr!=cview.cend_samples(); ++itr) {
+    EXPECT_TRUE(itr == cview.cbegin_samples() || prev < itr->first);
+    prev = itr->first;
+  }
+
+  tt_t::diti_list_t leaves = tree.get_leaf_cells();
+  EXPECT_EQ(cview.get_leaf_cells(), leaves);
+  for(auto c: leaves) {
+    EXPECT_EQ(cview.cell_has_child(c), tree.cell_has_child(c));
+    for(int i=0; i<2; i++)
+      for(int d=-1; d<2; d+=2)
+        EXPECT_EQ(cview.get_existing_neighbor(c, i, d), tree.get_existing_neighbor(c, i, d));
+  }
+  EXPECT_FALSE(tree.vertex_exists(tree.dita_to_diti({3, 3})));
+  EXPECT_FALSE(cview.vertex_exists(tree.dita_to_diti({3, 3})));
+
+  std::filesystem::remove(file_name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(tree_save, bad_files) {
+// What we are testing:
+//   - load() rejects missing files, other files, other tree types, truncated files, & corrupt sample counts without modifying the tree
+
+  typedef mjr::MR_rect_tree<7, double, 2, 1> tt_t;
+  typedef mjr::MR_rect_tree<7, double, 2, 2> ot_t;
+
+  std::string file_name = (std::filesystem::temp_directory_path() / "tree_save_bad_files.mrpt").string();
+  std::filesystem::remove(file_name);
+
+  auto f = [](tt_t::drpt_t x) { return x[0]+x[1]; };
+  tt_t tree;
+  tree.refine_grid(3, f);
+  std::size_t count = tree.get_sample_count();
+
+  EXPECT_EQ(tree.load(file_name), 1);
+
+  {
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    out << "This is not a tree file, but it is long enough to hold a tree file header of the right size.  Really.";
+  }
+  EXPECT_EQ(tree.load(file_name), 1);
+
+  ot_t otree;
+  otree.refine_grid(2, [](ot_t::drpt_t x) { return ot_t::rrpt_t({x[0], x[1]}); });
+  EXPECT_EQ(otree.save(file_name), 0);
+  EXPECT_EQ(tree.load(file_name), 1);
+
+  EXPECT_EQ(tree.save(file_name), 0);
+  std::filesystem::resize_file(file_name, std::filesystem::file_size(file_name) - 1);
+  tt_t tree2;
+  EXPECT_EQ(tree2.load(file_name), 1);
+  EXPECT_EQ(tree2.get_sample_count(), 0u);
+  tt_t::view_t view;
+  EXPECT_EQ(view.load(file_name), 1);
+  EXPECT_EQ(view.get_sample_count(), 0u);
+
+  EXPECT_EQ(tree.save(file_name), 0);
+  {
+    std::fstream io(file_name, std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t bad_count = uint64_t(1) << 63;
+    io.seekp(static_cast<std::streamoff>(tt_t::save_header_size - sizeof(uint64_t)));
+    io.write(reinterpret_cast<const char*>(&bad_count), sizeof(uint64_t));
+  }
+  tt_t tree3;
+  EXPECT_EQ(tree3.load(file_name), 1);
+  EXPECT_EQ(tree3.get_sample_count(), 0u);
+  tt_t::view_t view2;
+  EXPECT_EQ(view2.load(file_name), 1);
+  EXPECT_EQ(view2.get_sample_count(), 0u);
+
+  EXPECT_EQ(tree.get_sample_count(), count);
+
+  std::filesystem::remove(file_name);
+}